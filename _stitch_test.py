@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import pickle
 import unittest
 from typing import List, Tuple, overload
 
@@ -57,6 +58,78 @@ class StitchTest(unittest.TestCase):
     def test_delete(self):
         self.delete()
 
+    def test_iter(self):
+        s, _ = self.insert()
+        tiles = list(s)
+        self.assertEqual(len(s), len(tiles))
+        self.assertEqual([t.id for t in pytest_tiles(s)], [t.id for t in tiles])
+        # iterators resume where they stopped
+        it = iter(s)
+        self.assertIs(it, iter(it))
+        next(it)
+        self.assertEqual(len(s) - 1, len(list(it)))
+
+    def test_stats(self):
+        s, _ = self.insert()
+        st = s.stats(sliver=3)
+        self.assertEqual(len(s), st["solid"] + st["space"])
+        self.assertEqual(len(s), sum(st["area_histogram"].values()))
+
+    def test_segment_walk(self):
+        s, ts = self.insert()
+        walk = s.segment_walk(Pt(1, 3), 100, Dir.EAST)
+        self.assertEqual(4, len(walk))
+        self.assertEqual(ts[0].id, walk[1].id)
+        self.assertEqual(ts[0].id, s.ray_shoot(Pt(1, 3), Dir.EAST).id)
+        self.assertIsNone(s.ray_shoot(Pt(29, 23), Dir.SOUTH))
+
+    def test_nearest_solid(self):
+        s, ts = self.insert()
+        (tile, dist), = s.nearest_solid(Pt(1, 6))
+        self.assertEqual((ts[2].id, 3), (tile.id, dist))
+        self.assertEqual([], s.nearest_solid(Pt(1, 6), max_dist=2))
+        self.assertEqual(3, len(s.nearest_solid(Pt(1, 6), k=3)))
+
+    def test_bloat(self):
+        s, _ = self.insert()
+        b = s.bloat(1)
+        self.check_all(b)
+        self.assertIsNotNone(b.area_search(Pt(14, 1), Pt(1, 1)))
+        self.assertEqual(1, len(s.shrink(3)))
+
+    def test_extend(self):
+        s, _ = self.insert()
+        self.assertIsNone(s.insert(Pt(32, 2), Pt(2, 2)))
+        self.assertEqual(0, s.extend(Pt(0, 0), Pt(40, 30)))
+        self.check_all(s)
+        self.assertIsNotNone(s.insert(Pt(32, 2), Pt(2, 2)))
+        self.assertEqual(1, s.extend(Pt(1, 0), Pt(40, 30)))
+
+    def test_handle(self):
+        s, ts = self.insert()
+        t = ts[3]
+        s.delete(t)
+        self.assertFalse(t.exist)
+        # the slot is reused by a new tile, the old one stays deleted
+        u = s.insert(Pt(11, 11), Pt(8, 4))
+        self.assertFalse(t.exist)
+        self.assertIsNone(t.coord)
+        self.assertTrue(u.exist)
+        self.assertEqual(1, s.delete(t))
+
+    def test_pickle(self):
+        s, ts = self.insert()
+        s.delete(ts[0])
+        t = pickle.loads(pickle.dumps(s))
+        self.check_all(t)
+        self.assertEqual([x.id for x in s], [x.id for x in t])
+        # the free slots are kept, so later ids match
+        self.assertEqual(s.insert(Pt(0, 0), Pt(1, 1)).id, t.insert(Pt(0, 0), Pt(1, 1)).id)
+        self.assertIsNone(Stitch.deserialize(b"bad"))
+        # tiles keep their plane alive
+        tile = Stitch(t).tile(0)
+        self.assertTrue(tile.exist)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "stitch.hpp"
+
+// a rectangle [x0, x1) x [y0, y1), the coordinates may lie off the plane
+struct Rect {
+  Len x0, y0, x1, y1;
+};
+
+/* visit the union of `rects` (its complement inside `plane` if `invert`)
+ * as disjoint rectangles, sweeping strips from bottom to top */
+static void UnionRects(std::vector<Rect> rects, const Rect& plane, bool invert,
+                const std::function<void(const Tile&)>& visit) {
+  std::vector<Len> ys = {plane.y0, plane.y1};
+  for (const auto& r : rects) {
+    ys.push_back(r.y0);
+    ys.push_back(r.y1);
+  }
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+  std::sort(rects.begin(), rects.end(),
+            [](const Rect& a, const Rect& b) { return a.y0 < b.y0; });
+  std::multimap<Len, Rect> active;  // rects crossing the strip by x0
+  std::map<std::pair<Len, Len>, Len> open;  // run -> bottom y
+  auto close = [&](Len top, const std::map<std::pair<Len, Len>, Len>& runs) {
+    for (const auto& [run, bottom] : runs)
+      visit(Tile({run.first, bottom}, {run.second - run.first, top - bottom},
+                 false));
+  };
+  size_t next = 0;
+  for (size_t k = 0; k + 1 < ys.size(); k++) {
+    Len bottom = ys[k];
+    for (auto it = active.begin(); it != active.end();)
+      it = it->second.y1 <= bottom ? active.erase(it) : std::next(it);
+    for (; next < rects.size() && rects[next].y0 == bottom; next++)
+      active.insert({rects[next].x0, rects[next]});
+    // merge the active rects into sorted disjoint runs
+    std::vector<std::pair<Len, Len>> runs;
+    for (const auto& [x0, r] : active)
+      if (runs.size() && runs.back().second >= x0)
+        runs.back().second = std::max(runs.back().second, r.x1);
+      else
+        runs.push_back({x0, r.x1});
+    if (invert) {
+      std::vector<std::pair<Len, Len>> gaps;
+      Len x = plane.x0;
+      for (const auto& [lo, hi] : runs) {
+        if (x < lo) gaps.push_back({x, lo});
+        x = hi;
+      }
+      if (x < plane.x1) gaps.push_back({x, plane.x1});
+      runs = std::move(gaps);
+    }
+    // extend the open runs that continue, close the others
+    std::map<std::pair<Len, Len>, Len> cont;
+    for (const auto& run : runs) {
+      auto it = open.find(run);
+      cont[run] = it != open.end() ? it->second : bottom;
+      if (it != open.end()) open.erase(it);
+    }
+    close(bottom, open);
+    open = std::move(cont);
+  }
+  close(ys.back(), open);
+}
+
+void Stitch::Bloat(Len d,
+                   const std::function<void(const Tile&)>& visit) const {
+  const Rect plane = {coord_.x, coord_.y, coord_.x + size_.x,
+                      coord_.y + size_.y};
+  // shrinking the solid region grows the space tiles & the outside of the
+  // plane, the result is the rest
+  const bool shrink = d < 0;
+  const Len g = std::abs(d);
+  std::vector<Rect> rects;
+  auto add = [&](Rect r) {
+    r = {std::max(r.x0, plane.x0), std::max(r.y0, plane.y0),
+         std::min(r.x1, plane.x1), std::min(r.y1, plane.y1)};
+    if (r.x0 < r.x1 && r.y0 < r.y1) rects.push_back(r);
+  };
+  for (auto id : Tiles()) {
+    const auto& t = Ref(id);
+    if (t.is_space != shrink) continue;
+    add({t.coord.x - g, t.coord.y - g, t.coord.x + t.size.x + g,
+         t.coord.y + t.size.y + g});
+  }
+  if (shrink) {
+    add({plane.x0, plane.y0, plane.x0 + g, plane.y1});
+    add({plane.x1 - g, plane.y0, plane.x1, plane.y1});
+    add({plane.x0, plane.y0, plane.x1, plane.y0 + g});
+    add({plane.x0, plane.y1 - g, plane.x1, plane.y1});
+  }
+  UnionRects(std::move(rects), plane, shrink, visit);
+}
+
+Stitch Stitch::Bloat(Len d) const {
+  Stitch s(coord_, size_);
+  Bloat(d, [&](const Tile& t) { s.Insert(t); });
+  return s;
+}
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "stitch.hpp"
+
+// The tiles of a plane crossing the current strip, by their left edge
+// clipped to [x0, x1) which they cover together.
+struct Row {
+  const Stitch& s;
+  Len x0, x1;
+  std::map<Len, Id> tiles;
+
+  bool Covers(const Tile& t) const {
+    return t.coord.x < x1 && t.LowerRightCorner().x > x0;
+  }
+  /* add tile `id` if it lies across [x0, x1) */
+  void Add(Id id) {
+    const auto& t = *s.Get(id);
+    if (Covers(t)) tiles.emplace(std::max(t.coord.x, x0), id);
+  }
+  /* add the tiles along y=`y` */
+  void Walk(Len y) {
+    for (auto id : s.SegmentWalk({x0, y}, x1 - x0, Stitch::EAST)) Add(id);
+  }
+  /* drop tile `id`, adding the span it leaves to `dirty` */
+  void Erase(Id id, std::vector<std::pair<Len, Len>>& dirty) {
+    const auto& t = *s.Get(id);
+    Len lo = std::max(t.coord.x, x0);
+    tiles.erase(lo);
+    dirty.push_back({lo, std::min(t.LowerRightCorner().x, x1)});
+  }
+  // is x solid, `end` is set to where that may change
+  bool At(Len x, Len& end) const {
+    if (tiles.empty() || x >= x1) {
+      end = kLenMax;
+      return false;
+    }
+    if (x < x0) {
+      end = x0;
+      return false;
+    }
+    const auto& t = *s.Get(std::prev(tiles.upper_bound(x))->second);
+    end = std::min(t.LowerRightCorner().x, x1);
+    return !t.is_space;
+  }
+};
+
+/* visit `a` `op` `b` inside the plane of `a` as solid tiles & space tiles
+ * in maximal horizontal strips, by closing strip by strip from top to
+ * bottom. The rows of both planes advance together at the bottom edges of
+ * their tiles, so each tile enters a row once, and the result is only
+ * recomputed around the spans where a row changed. */
+static void Sweep(const Stitch& a, const Stitch& b, Stitch::BoolOp op,
+                  const std::function<void(const Tile&)>& visit) {
+  const Tile pa = a.Plane(), pb = b.Plane();
+  const Len ax0 = pa.coord.x, ax1 = pa.LowerRightCorner().x;
+  const Len ay0 = pa.coord.y, ay1 = pa.UpperLeftCorner().y;
+  const Len by0 = std::max(ay0, pb.coord.y),
+            by1 = std::min(ay1, pb.UpperLeftCorner().y);
+  Row rows[2] = {{a, ax0, ax1, {}},
+                 {b, std::max(ax0, pb.coord.x),
+                  std::min(ax1, pb.LowerRightCorner().x), {}}};
+  const bool has_b = b.NumTiles() && rows[1].x0 < rows[1].x1 && by0 < by1;
+  // tiles leaving the rows at their bottom edge (a null one marks where the
+  // plane of `b` starts), from top to bottom
+  std::vector<std::tuple<Len, int, Id>> events;
+  for (int k = 0; k < (has_b ? 2 : 1); k++)
+    for (auto id : rows[k].s.Tiles()) {
+      const auto& t = *rows[k].s.Get(id);
+      if (ay0 < t.coord.y && t.coord.y < ay1 && rows[k].Covers(t))
+        events.push_back({t.coord.y, k, id});
+    }
+  if (has_b && by1 < ay1) events.push_back({by1, 1, kNullId});
+  std::sort(events.begin(), events.end(), std::greater<>());
+  size_t i = 0;
+  auto next_y = [&] {
+    return i < events.size() ? std::get<0>(events[i]) : ay0;
+  };
+
+  // runs of the result across the strips above, by lower x, which partition
+  // [ax0, ax1) alternating between solid & space
+  struct Run {
+    Len hi, top;
+    bool is_space;
+  };
+  std::map<Len, Run> open;
+  auto close = [&](Len lo, const Run& run, Len bottom) {
+    visit(Tile({lo, bottom}, {run.hi - lo, run.top - bottom}, run.is_space));
+  };
+  // recompute the runs of the strip below `y` inside [lo, hi)
+  auto update = [&](Len lo, Len hi, Len y) {
+    std::vector<std::pair<Len, Run>> runs;
+    for (Len x = lo; x < hi;) {
+      Len ea, eb;
+      bool sa = rows[0].At(x, ea), sb = rows[1].At(x, eb);
+      bool in = op == Stitch::AND   ? sa && sb
+                : op == Stitch::OR  ? sa || sb
+                : op == Stitch::NOT ? sa && !sb
+                                    : sa != sb;
+      // a plane fixing the result alone is stepped over in one go
+      bool fix_a = op == Stitch::OR ? sa : op != Stitch::XOR && !sa;
+      bool fix_b = op == Stitch::AND ? !sb : op != Stitch::XOR && sb;
+      Len end = fix_a && fix_b ? std::max(ea, eb)
+                : fix_a        ? ea
+                : fix_b        ? eb
+                               : std::min(ea, eb);
+      end = std::min(end, hi);
+      if (runs.size() && runs.back().second.is_space == !in)
+        runs.back().second.hi = end;
+      else
+        runs.push_back({x, {end, y, !in}});
+      x = end;
+    }
+    // keep the runs which continue, close the others
+    auto first = open.lower_bound(lo), last = open.lower_bound(hi);
+    std::vector<std::pair<Len, Run>> old(first, last);
+    open.erase(first, last);
+    size_t j = 0;
+    for (auto& [x, run] : runs) {
+      for (; j < old.size() && old[j].first < x; j++)
+        close(old[j].first, old[j].second, y);
+      if (j < old.size() && old[j].first == x &&
+          old[j].second.hi == run.hi &&
+          old[j].second.is_space == run.is_space)
+        run.top = old[j++].second.top;
+      open.emplace(x, run);
+    }
+    for (; j < old.size(); j++) close(old[j].first, old[j].second, y);
+  };
+
+  std::vector<std::pair<Len, Len>> dirty = {{ax0, ax1}};
+  rows[0].Walk(next_y());
+  if (has_b && by1 == ay1) rows[1].Walk(next_y());
+  for (Len y = ay1;;) {
+    // widen each span by one run on both sides: the runs just outside then
+    // keep their type, so no new run merges across the span
+    for (auto& [lo, hi] : dirty) {
+      auto it = open.upper_bound(lo);
+      if (it != open.begin() && --it != open.begin()) --it;
+      if (it != open.end() && it->first < lo) lo = it->first;
+      it = open.lower_bound(hi);
+      hi = it != open.end() ? it->second.hi : ax1;
+    }
+    std::sort(dirty.begin(), dirty.end());
+    for (size_t k = 0; k < dirty.size();) {
+      auto [lo, hi] = dirty[k];
+      for (k++; k < dirty.size() && dirty[k].first < hi; k++)
+        hi = std::max(hi, dirty[k].second);
+      update(lo, hi, y);
+    }
+    if (i == events.size()) break;
+    // advance the rows past the tiles ending at `y`
+    y = std::get<0>(events[i]);
+    dirty.clear();
+    std::vector<std::pair<int, Id>> ended;
+    bool b_starts = false;
+    for (; i < events.size() && std::get<0>(events[i]) == y; i++) {
+      auto [_, k, id] = events[i];
+      if (id == kNullId) {
+        b_starts = true;
+        continue;
+      }
+      rows[k].Erase(id, dirty);
+      ended.push_back({k, id});
+    }
+    for (auto [k, id] : ended)
+      for (auto n : rows[k].s.BottomNeighbors(id)) rows[k].Add(n);
+    if (b_starts) {
+      rows[1].Walk(next_y());
+      dirty.push_back({rows[1].x0, rows[1].x1});
+    }
+  }
+  for (const auto& [lo, run] : open) close(lo, run, ay0);
+}
+
+void Stitch::Boolean(const Stitch& a, const Stitch& b, BoolOp op,
+                     const std::function<void(const Tile&)>& visit) {
+  if (!a.NumTiles()) return;
+  Sweep(a, b, op, [&](const Tile& t) {
+    if (!t.is_space) visit(t);
+  });
+}
+
+Stitch Stitch::Boolean(const Stitch& a, const Stitch& b, BoolOp op) {
+  Stitch s(a.coord_, a.size_);
+  if (!a.NumTiles()) return s;
+  std::vector<Tile> tiles;
+  Sweep(a, b, op, [&](const Tile& t) { tiles.push_back(t); });
+  s.Build(tiles);
+  return s;
+}
+
+std::vector<Id> Stitch::Build(const std::vector<Tile>& tiles) {
+  for (auto id : Tiles()) FreeTile(id);
+  std::vector<Id> ids;
+  for (const auto& t : tiles) {
+    ids.push_back(AllocTile());
+    Ref(ids.back()) = Tile(t.coord, t.size, t.is_space);
+  }
+  // (the line of an edge, where the edge starts along it, tile)
+  typedef std::tuple<Len, Len, Id> Edge;
+  std::vector<Edge> lefts, rights, bottoms, tops;
+  for (auto id : ids) {
+    const auto& t = Ref(id);
+    lefts.push_back({t.coord.x, t.coord.y, id});
+    rights.push_back({t.LowerRightCorner().x, t.coord.y, id});
+    bottoms.push_back({t.coord.y, t.coord.x, id});
+    tops.push_back({t.UpperLeftCorner().y, t.coord.x, id});
+  }
+  for (auto* edges : {&lefts, &rights, &bottoms, &tops})
+    std::sort(edges->begin(), edges->end());
+  // the tile of `edges` along `line` holding the point at `at`, the point
+  // belongs to the edge before it if not `closed`
+  auto find = [](const std::vector<Edge>& edges, Len line, Len at,
+                 bool closed) {
+    auto it = std::partition_point(edges.begin(), edges.end(),
+                                   [&](const Edge& e) {
+                                     auto [l, x, _] = e;
+                                     return l < line ||
+                                            (l == line && (closed ? x <= at
+                                                                  : x < at));
+                                   });
+    if (it == edges.begin() || std::get<0>(*--it) != line) return kNullId;
+    return std::get<2>(*it);
+  };
+  for (auto id : ids) {
+    auto& t = Ref(id);
+    t.bl = find(rights, t.coord.x, t.coord.y, true);
+    t.lb = find(tops, t.coord.y, t.coord.x, true);
+    t.tr = find(lefts, t.LowerRightCorner().x, t.UpperLeftCorner().y, false);
+    t.rt = find(bottoms, t.UpperLeftCorner().y, t.LowerRightCorner().x, false);
+  }
+  return ids;
+}
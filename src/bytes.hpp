@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include "tile.hpp"
+
+// appends fixed-size values to a byte string in native byte order
+class ByteWriter {
+ public:
+  ByteWriter(std::string& out) : out_(out) {}
+  template <typename T>
+  void Put(const T& v) {
+    out_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+  /* the geometry of `t` */
+  void Put(const Tile& t) {
+    Put(t.coord.x);
+    Put(t.coord.y);
+    Put(t.size.x);
+    Put(t.size.y);
+  }
+  void Put(const std::string& s) {
+    Put(uint16_t(s.size()));
+    out_.append(s);
+  }
+
+ protected:
+  std::string& out_;
+};
+
+// reads the values written by `ByteWriter`, failing past the end
+class ByteReader {
+ public:
+  ByteReader(const char* data, size_t size) : p_(data), end_(data + size) {}
+  bool Ok() const { return ok_; }
+  bool Done() const { return p_ == end_; }
+  template <typename T>
+  T Get() {
+    T v{};
+    if (size_t(end_ - p_) < sizeof(T)) {
+      ok_ = false;
+      return v;
+    }
+    std::memcpy(&v, p_, sizeof(T));
+    p_ += sizeof(T);
+    return v;
+  }
+  /* the geometry of a tile, failing if it is not a legal rectangle */
+  Tile GetTile() {
+    Len x = Get<Len>(), y = Get<Len>(), w = Get<Len>(), h = Get<Len>();
+    if (!Pt(x, y).InQuadrantI() || !Pt(w, h).IsSize(Pt(x, y))) ok_ = false;
+    return ok_ ? Tile({x, y}, {w, h}) : Tile();
+  }
+  std::string GetString() {
+    size_t n = Get<uint16_t>();
+    if (!ok_ || size_t(end_ - p_) < n) {
+      ok_ = false;
+      return {};
+    }
+    std::string s(p_, n);
+    p_ += n;
+    return s;
+  }
+
+ private:
+  const char *p_, *end_;
+  bool ok_{true};
+};
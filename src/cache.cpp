@@ -0,0 +1,105 @@
+#include "cache.hpp"
+
+#include <algorithm>
+#include <functional>
+
+/* closed rectangles [`lo`, `hi`] & `t` intersect (touching included) */
+static bool Intersect(const Pt& lo, const Pt& hi, const Tile& t) {
+  return lo.x <= t.coord.x + t.size.x && t.coord.x <= hi.x &&
+         lo.y <= t.coord.y + t.size.y && t.coord.y <= hi.y;
+}
+
+size_t CachedStitch::Hash::operator()(const Key& k) const {
+  std::hash<Len> h;
+  size_t v = k.kind;
+  for (Len l : {k.area.coord.x, k.area.coord.y, k.area.size.x, k.area.size.y})
+    v ^= h(l) + 0x9e3779b97f4a7c15 + (v << 6) + (v >> 2);
+  return v;
+}
+
+CachedStitch::CachedStitch(Stitch& stitch, size_t capacity)
+    : s_(stitch), capacity_(std::max<size_t>(capacity, 1)) {
+  s_.TrackTouched(true);
+}
+
+Id CachedStitch::AreaSearch(const Tile& area) {
+  const auto& e = Lookup(SEARCH, area);
+  return e.ids.empty() ? kNullId : e.ids.front();
+}
+
+const std::vector<Id>& CachedStitch::AreaEnum(const Tile& area) {
+  return Lookup(ENUM, area).ids;
+}
+
+const CachedStitch::Entry& CachedStitch::Lookup(Kind kind, const Tile& area) {
+  Key key{kind, Tile(area.coord, area.size)};
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    stats_.hits++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return lru_.front();
+  }
+  stats_.misses++;
+  Entry e{key, {}};
+  if (kind == SEARCH) {
+    Id id = s_.AreaSearch(area);
+    if (id != kNullId) e.ids.push_back(id);
+  } else {
+    e.ids = s_.AreaEnum(area);
+  }
+  if (lru_.size() >= capacity_) {
+    stats_.evictions++;
+    Erase(std::prev(lru_.end()));
+  }
+  lru_.push_front(std::move(e));
+  index_[key] = lru_.begin();
+  stats_.entries++;
+  stats_.bytes += Bytes(lru_.front());
+  return lru_.front();
+}
+
+Id CachedStitch::Insert(const Tile& tile, Id start) {
+  Id id = s_.Insert(tile, start);
+  if (id != kNullId) Invalidate(tile);
+  return id;
+}
+
+std::optional<Tile> CachedStitch::Delete(Id id) {
+  auto tile = s_.Delete(id);
+  if (tile) Invalidate(*tile);
+  return tile;
+}
+
+void CachedStitch::Clear() {
+  lru_.clear();
+  index_.clear();
+  stats_.entries = stats_.bytes = 0;
+}
+
+void CachedStitch::Invalidate(const Tile& tile) {
+  // the tiles touched cover every area whose tiles changed, the freed ones
+  // lying inside the tiles they were merged into
+  Pt lo = tile.LowerLeftCorner(), hi = tile.UpperRightCorner();
+  for (Id id : s_.Touched()) {
+    auto t = s_.At(id);
+    if (!t) continue;
+    lo = {std::min(lo.x, t->coord.x), std::min(lo.y, t->coord.y)};
+    hi = {std::max(hi.x, t->UpperRightCorner().x),
+          std::max(hi.y, t->UpperRightCorner().y)};
+  }
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    auto next = std::next(it);
+    if (Intersect(lo, hi, it->key.area)) {
+      stats_.invalidations++;
+      Erase(it);
+    }
+    it = next;
+  }
+}
+
+void CachedStitch::Erase(Lru::iterator it) {
+  stats_.entries--;
+  stats_.bytes -= Bytes(*it);
+  index_.erase(it->key);
+  lru_.erase(it);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// Caches the results of AreaSearch & AreaEnum by query window, keeping the
+// `capacity` most recently used ones. Mutations go through this object,
+// which drops the cached windows intersecting the bounding box of the tiles
+// touched by the mutation (the split & merged neighbors included), so a
+// repeated query is a hash lookup unless an edit came near it.
+class CachedStitch {
+ public:
+  struct Stats {
+    size_t hits{0}, misses{0};
+    size_t invalidations{0};  // entries dropped by mutations
+    size_t evictions{0};      // entries dropped for capacity
+    size_t entries{0};
+    size_t bytes{0};  // estimated memory held by the entries
+  };
+
+  CachedStitch() = delete;
+  CachedStitch(const CachedStitch&) = delete;
+  // `stitch` must only be mutated through this object while it lives
+  // (or `Clear` be called after), touched tracking is enabled
+  explicit CachedStitch(Stitch& stitch, size_t capacity = 1024);
+
+  Id AreaSearch(const Tile& area);
+  // the result is valid until the next call
+  const std::vector<Id>& AreaEnum(const Tile& area);
+  // mutate as `Stitch::Insert` & `Stitch::Delete`
+  Id Insert(const Tile& tile, Id start = kNullId);
+  std::optional<Tile> Delete(Id id);
+  /* drop all entries */
+  void Clear();
+  const Stats& GetStats() const { return stats_; }
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  enum Kind : uint8_t { SEARCH = 0, ENUM };
+  struct Key {
+    Kind kind;
+    Tile area;
+    bool operator==(const Key& k) const {
+      return kind == k.kind && area.coord == k.area.coord &&
+             area.size == k.area.size;
+    }
+  };
+  struct Hash {
+    size_t operator()(const Key& k) const;
+  };
+  struct Entry {
+    Key key;
+    std::vector<Id> ids;  // the single result of `SEARCH` if found
+  };
+  typedef std::list<Entry> Lru;  // most recently used first
+
+  Stitch& s_;
+  const size_t capacity_;
+  Lru lru_;
+  std::unordered_map<Key, Lru::iterator, Hash> index_;
+  Stats stats_;
+
+  // the entry of `key`, computed if missing
+  const Entry& Lookup(Kind kind, const Tile& area);
+  // drop the entries intersecting the tiles touched by the last mutation
+  void Invalidate(const Tile& tile);
+  void Erase(Lru::iterator it);
+  static size_t Bytes(const Entry& e) {
+    return sizeof(Entry) + sizeof(Lru::iterator) + e.ids.capacity() * sizeof(Id);
+  }
+};
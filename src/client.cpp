@@ -0,0 +1,155 @@
+#include "client.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+Client::~Client() { Close(); }
+
+int Client::Connect(const std::string& path) {
+  Close();
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return 1;
+  std::memcpy(addr.sun_path, path.c_str(), path.size());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return 1;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return 1;
+  }
+  fd_ = fd;
+  return 0;
+}
+
+void Client::Close() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+  in_.clear();
+}
+
+std::vector<Response> Client::Call(std::vector<Request> requests) {
+  std::vector<Response> responses;
+  if (fd_ < 0) return responses;
+  std::string out;
+  for (auto& req : requests) {
+    if (req.seq == 0) req.seq = ++seq_;
+    Encode(req, out);
+  }
+  for (size_t pos = 0; pos < out.size();) {
+    auto n = send(fd_, out.data() + pos, out.size() - pos, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      Close();
+      return {};
+    }
+    pos += n;
+  }
+  char buf[1 << 16];
+  size_t pos = 0;
+  while (responses.size() < requests.size()) {
+    size_t used = 0;
+    Response res;
+    auto st = Decode(in_.data() + pos, in_.size() - pos, used, res);
+    if (st == FRAME_OK) {
+      responses.push_back(std::move(res));
+      pos += used;
+      continue;
+    }
+    auto n = st == FRAME_BAD ? -1 : read(fd_, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      Close();
+      return {};
+    }
+    in_.erase(0, pos);
+    pos = 0;
+    in_.append(buf, n);
+  }
+  in_.erase(0, pos);
+  return responses;
+}
+
+Response Client::Call(Request request) {
+  std::vector<Request> requests = {std::move(request)};
+  auto responses = Call(std::move(requests));
+  if (responses.empty()) {
+    Response res;
+    res.status = 1;
+    return res;
+  }
+  return responses.front();
+}
+
+int Client::Create(const std::string& plane, const Pt& coord, const Pt& size) {
+  Request req;
+  req.op = Request::CREATE;
+  req.plane = plane;
+  req.area = Tile(coord, size);
+  return Call(std::move(req)).status;
+}
+
+int Client::Drop(const std::string& plane) {
+  Request req;
+  req.op = Request::DROP;
+  req.plane = plane;
+  return Call(std::move(req)).status;
+}
+
+Id Client::Insert(const std::string& plane, const Tile& tile) {
+  Request req;
+  req.op = Request::INSERT;
+  req.plane = plane;
+  req.area = tile;
+  auto res = Call(std::move(req));
+  return res.status || res.ids.empty() ? kNullId : res.ids.front();
+}
+
+std::optional<Tile> Client::Delete(const std::string& plane, Id id) {
+  Request req;
+  req.op = Request::DELETE;
+  req.plane = plane;
+  req.id = id;
+  auto res = Call(std::move(req));
+  if (res.status || res.tiles.empty()) return std::nullopt;
+  return res.tiles.front();
+}
+
+std::optional<Tile> Client::At(const std::string& plane, Id id) {
+  Request req;
+  req.op = Request::TILE;
+  req.plane = plane;
+  req.id = id;
+  auto res = Call(std::move(req));
+  if (res.status || res.tiles.empty()) return std::nullopt;
+  return res.tiles.front();
+}
+
+Id Client::PointFinding(const std::string& plane, const Pt& pt) {
+  Request req;
+  req.op = Request::POINT_FIND;
+  req.plane = plane;
+  req.pt = pt;
+  auto res = Call(std::move(req));
+  return res.status || res.ids.empty() ? kNullId : res.ids.front();
+}
+
+Id Client::AreaSearch(const std::string& plane, const Tile& area) {
+  Request req;
+  req.op = Request::AREA_SEARCH;
+  req.plane = plane;
+  req.area = area;
+  auto res = Call(std::move(req));
+  return res.status || res.ids.empty() ? kNullId : res.ids.front();
+}
+
+std::vector<Id> Client::AreaEnum(const std::string& plane, const Tile& area) {
+  Request req;
+  req.op = Request::AREA_ENUM;
+  req.plane = plane;
+  req.area = area;
+  return Call(std::move(req)).ids;
+}
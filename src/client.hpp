@@ -0,0 +1,47 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+
+// A blocking client of `Server`. `Call` pipelines a batch of requests on
+// the connection and waits for all of their responses, the helpers send a
+// single request.
+class Client {
+ public:
+  Client() = default;
+  Client(const Client&) = delete;
+  ~Client();
+
+  // connect to the server at the socket `path`, return 1 if failed
+  int Connect(const std::string& path);
+  void Close();
+  /* connected? */
+  bool Connected() const { return fd_ >= 0; }
+  // send `requests` (numbered by `seq` if unset) & return their responses
+  // in order, empty if the connection is broken
+  std::vector<Response> Call(std::vector<Request> requests);
+
+  // return 1 if failed (the plane exists)
+  int Create(const std::string& plane, const Pt& coord, const Pt& size);
+  int Drop(const std::string& plane);
+  // the inserted tile or `kNullId`
+  Id Insert(const std::string& plane, const Tile& tile);
+  std::optional<Tile> Delete(const std::string& plane, Id id);
+  std::optional<Tile> At(const std::string& plane, Id id);
+  // the id of the tile at `pt` or `kNullId`
+  Id PointFinding(const std::string& plane, const Pt& pt);
+  // the id of a solid tile in `area` or `kNullId`
+  Id AreaSearch(const std::string& plane, const Tile& area);
+  std::vector<Id> AreaEnum(const std::string& plane, const Tile& area);
+
+ private:
+  int fd_{-1};
+  uint32_t seq_{0};
+  std::string in_;  // bytes received past the last response
+
+  // send one request & wait for its response
+  Response Call(Request request);
+};
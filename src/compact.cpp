@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "stitch.hpp"
+
+/* the space of `plane` around the disjoint solid `tiles` inside it, in
+ * maximal horizontal strips, by closing strip by strip from top to bottom
+ * as the tiles start & end; only the space around the tiles starting or
+ * ending at a strip is recomputed there. */
+static std::vector<Tile> Space(const Tile& plane,
+                               const std::vector<Tile>& tiles) {
+  const Len x0 = plane.coord.x, x1 = plane.LowerRightCorner().x;
+  const Len y0 = plane.coord.y, y1 = plane.UpperLeftCorner().y;
+  // (y, ends, tile) from top to bottom, a tile ending at `y` before the
+  // ones starting there, which may have the same left edge
+  std::vector<std::tuple<Len, bool, size_t>> events;
+  for (size_t k = 0; k < tiles.size(); k++) {
+    events.push_back({tiles[k].UpperLeftCorner().y, false, k});
+    if (tiles[k].coord.y > y0) events.push_back({tiles[k].coord.y, true, k});
+  }
+  std::sort(events.begin(), events.end(), std::greater<>());
+  std::map<Len, Len> solid;  // x ranges of the tiles crossing the strip
+  struct Run {
+    Len hi, top;
+  };
+  std::map<Len, Run> open;  // space runs across the strips above, by lower x
+  std::vector<Tile> space;
+  auto close = [&](Len lo, const Run& run, Len bottom) {
+    space.push_back(Tile({lo, bottom}, {run.hi - lo, run.top - bottom}, true));
+  };
+  // recompute the runs of the strip below `y` inside [lo, hi)
+  auto update = [&](Len lo, Len hi, Len y) {
+    std::vector<std::pair<Len, Run>> runs;
+    Len x = lo;
+    for (auto it = solid.lower_bound(lo); it != solid.end() && it->first < hi;
+         ++it) {
+      if (x < it->first) runs.push_back({x, {it->first, y}});
+      x = it->second;
+    }
+    if (x < hi) runs.push_back({x, {hi, y}});
+    auto first = open.lower_bound(lo), last = open.lower_bound(hi);
+    std::vector<std::pair<Len, Run>> old(first, last);
+    open.erase(first, last);
+    size_t j = 0;
+    for (auto& [x, run] : runs) {
+      for (; j < old.size() && old[j].first < x; j++)
+        close(old[j].first, old[j].second, y);
+      if (j < old.size() && old[j].first == x && old[j].second.hi == run.hi)
+        run.top = old[j++].second.top;
+      open.emplace(x, run);
+    }
+    for (; j < old.size(); j++) close(old[j].first, old[j].second, y);
+  };
+  std::vector<std::pair<Len, Len>> dirty = {{x0, x1}};
+  size_t i = 0;
+  for (Len y = y1;;) {
+    for (; i < events.size() && std::get<0>(events[i]) == y; i++) {
+      const auto& t = tiles[std::get<2>(events[i])];
+      if (std::get<1>(events[i]))
+        solid.erase(t.coord.x);
+      else
+        solid.emplace(t.coord.x, t.LowerRightCorner().x);
+      dirty.push_back({t.coord.x, t.LowerRightCorner().x});
+    }
+    // widen each span to the tiles around it, whose runs are unchanged
+    for (auto& [lo, hi] : dirty) {
+      auto it = solid.lower_bound(lo);
+      lo = it == solid.begin() ? x0 : std::prev(it)->second;
+      it = solid.lower_bound(hi);
+      hi = it == solid.end() ? x1 : it->first;
+    }
+    std::sort(dirty.begin(), dirty.end());
+    for (size_t k = 0; k < dirty.size();) {
+      auto [lo, hi] = dirty[k];
+      for (k++; k < dirty.size() && dirty[k].first <= hi; k++)
+        hi = std::max(hi, dirty[k].second);
+      update(lo, hi, y);
+    }
+    if (i == events.size()) break;
+    y = std::get<0>(events[i]);
+    dirty.clear();
+  }
+  for (const auto& [lo, run] : open) close(lo, run, y0);
+  return space;
+}
+
+void Stitch::Compact(Axis axis, Len spacing,
+                     const std::function<void(Id, const Tile&)>& visit) const {
+  if (axis == Y) {
+    // compact the transposed plane along x, built at once from the solid
+    // tiles & the space around them
+    auto flip = [](const Tile& t) {
+      return Tile({t.coord.y, t.coord.x}, {t.size.y, t.size.x}, t.is_space);
+    };
+    std::vector<Id> solid;
+    std::vector<Tile> tiles;
+    for (Id id : Tiles()) {
+      if (Ref(id).is_space) continue;
+      solid.push_back(id);
+      tiles.push_back(flip(Ref(id)));
+    }
+    const Tile plane = flip(Plane());
+    auto space = Space(plane, tiles);
+    tiles.insert(tiles.end(), space.begin(), space.end());
+    Stitch t(plane.coord, plane.size);
+    auto ids = t.Build(tiles);
+    std::vector<Id> origin(t.NumSlots(), kNullId);  // id in `t` -> id
+    for (size_t k = 0; k < solid.size(); k++) origin[ids[k]] = solid[k];
+    t.Compact(X, spacing,
+              [&](Id tid, const Tile& tile) { visit(origin[tid], flip(tile)); });
+    return;
+  }
+  // an edge a -> b: b stays at least `gap` right of a
+  struct Edge {
+    Id to;
+    Len gap;
+  };
+  std::vector<std::vector<Edge>> edges(NumSlots());
+  std::vector<int> preds(NumSlots(), 0);
+  auto add = [&](Id a, Id b, Len gap) {
+    edges[a].push_back({b, gap});
+    preds[b]++;
+  };
+  std::vector<Id> sources;
+  for (Id a : Tiles()) {
+    const auto& ta = Ref(a);
+    if (ta.is_space) continue;
+    const Len right = ta.LowerRightCorner().x;
+    for (Id n : RightNeighbors(a)) {
+      const auto& tn = Ref(n);
+      if (!tn.is_space) {
+        add(a, n, 0);  // abutting
+        continue;
+      }
+      // a space strip is bounded at right by the solid tiles a sees
+      Len lo = std::max(ta.coord.y, tn.coord.y),
+          hi = std::min(ta.UpperLeftCorner().y, tn.UpperLeftCorner().y);
+      for (Id b : RightNeighbors(n)) {
+        const auto& tb = Ref(b);
+        if (tb.is_space || tb.UpperLeftCorner().y <= lo || hi <= tb.coord.y)
+          continue;
+        add(a, b, std::min(spacing, tb.coord.x - right));
+      }
+    }
+  }
+  // longest paths from the left edge in topological order, edges always
+  // point right so there is no cycle
+  std::vector<Len> x(NumSlots(), coord_.x);
+  for (Id id : Tiles())
+    if (!Ref(id).is_space && preds[id] == 0) sources.push_back(id);
+  while (sources.size()) {
+    Id a = sources.back();
+    sources.pop_back();
+    const auto& ta = Ref(a);
+    visit(a, Tile({x[a], ta.coord.y}, ta.size, false));
+    for (const auto& e : edges[a]) {
+      x[e.to] = std::max(x[e.to], x[a] + ta.size.x + e.gap);
+      if (--preds[e.to] == 0) sources.push_back(e.to);
+    }
+  }
+}
+
+Stitch Stitch::Compact(Axis axis, Len spacing) const {
+  std::vector<Tile> tiles;
+  Compact(axis, spacing, [&](Id, const Tile& t) { tiles.push_back(t); });
+  auto space = Space(Plane(), tiles);
+  tiles.insert(tiles.end(), space.begin(), space.end());
+  Stitch s(coord_, size_);
+  s.Build(tiles);
+  return s;
+}
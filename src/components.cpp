@@ -0,0 +1,63 @@
+#include <atomic>
+#include <memory>
+
+#include "parallel.hpp"
+#include "stitch.hpp"
+
+// a lock-free union-find whose roots are the smallest ids of their sets
+class UnionFind {
+ public:
+  UnionFind(size_t n) : parent_(new std::atomic<Id>[n]) {
+    for (size_t i = 0; i < n; i++)
+      parent_[i].store(i, std::memory_order_relaxed);
+  }
+  Id Find(Id x) {
+    for (;;) {
+      Id p = parent_[x].load();
+      if (p == x) return x;
+      // halve the path, losing the race only skips the shortcut
+      Id gp = parent_[p].load();
+      if (p != gp) parent_[x].compare_exchange_weak(p, gp);
+      x = gp;
+    }
+  }
+  void Unite(Id a, Id b) {
+    for (;;) {
+      a = Find(a);
+      b = Find(b);
+      if (a == b) return;
+      if (a < b) std::swap(a, b);
+      // link the larger root, retry if it was linked meanwhile
+      Id expected = a;
+      if (parent_[a].compare_exchange_strong(expected, b)) return;
+    }
+  }
+
+ private:
+  std::unique_ptr<std::atomic<Id>[]> parent_;
+};
+
+std::vector<Id> Stitch::ConnectedComponents(
+    const std::function<bool(const Tile&)>& filter, size_t threads) const {
+  const size_t n = NumSlots();
+  auto member = [&](Id id) {
+    return tiles_.Has(id) && !Ref(id).is_space && (!filter || filter(Ref(id)));
+  };
+  std::vector<char> in(n);
+  for (size_t i = 0; i < n; i++) in[i] = member(i);
+  UnionFind uf(n);
+  // the right & top neighbors cover every touching pair once
+  ParallelFor(n, threads, [&](size_t begin, size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      if (!in[i]) continue;
+      for (Id id : RightNeighbors(i))
+        if (in[id]) uf.Unite(i, id);
+      for (Id id : TopNeighbors(i))
+        if (in[id]) uf.Unite(i, id);
+    }
+  });
+  std::vector<Id> components(n, kNullId);
+  for (size_t i = 0; i < n; i++)
+    if (in[i]) components[i] = uf.Find(i);
+  return components;
+}
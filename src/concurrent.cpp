@@ -0,0 +1,289 @@
+#include "concurrent.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+ConcurrentStitch::ConcurrentStitch(Stitch& stitch, size_t reserve)
+    : s_(stitch) {
+  s_.TrackTouched(false);
+  s_.DisableSummary();
+  for (auto id : s_.Tiles()) {
+    const auto& t = s_.Ref(id);
+    if (!t.is_space) solid_[id] = {t.coord.y, t.UpperLeftCorner().y};
+  }
+  Reserve(reserve);
+}
+
+template <typename F>
+auto ConcurrentStitch::Exclusive(F f) {
+  std::unique_lock<std::shared_mutex> lock(resize_);
+  return f();
+}
+
+void ConcurrentStitch::Reserve(size_t n) {
+  Exclusive([&] { return Grow(n); });
+}
+
+int ConcurrentStitch::Grow(size_t n) {
+  s_.tiles_.Reserve(n);
+  return 0;
+}
+
+void ConcurrentStitch::Lock(const Band& band) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [&] {
+    return std::none_of(bands_.begin(), bands_.end(),
+                        [&](const Band& b) { return b.Overlap(band); });
+  });
+  bands_.push_back(band);
+}
+
+void ConcurrentStitch::Unlock(const Band& band) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bands_.erase(std::find_if(bands_.begin(), bands_.end(), [&](const Band& b) {
+      return b.lo == band.lo && b.hi == band.hi;
+    }));
+  }
+  released_.notify_all();
+}
+
+int ConcurrentStitch::Take(size_t n, std::vector<size_t>& pool) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // enough free slots are never appended, so the storage is not resized
+  if (s_.tiles_.NumFree() < n + kMinSlots) return 1;
+  for (; n; n--) pool.push_back(s_.tiles_.Take());
+  return 0;
+}
+
+void ConcurrentStitch::Give(std::vector<size_t>& pool, Id inserted) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto id : pool) s_.tiles_.Give(id);
+  pool.clear();
+  if (inserted != kNullId) {
+    const auto& t = s_.Ref(inserted);
+    solid_[inserted] = {t.coord.y, t.UpperLeftCorner().y};
+  }
+}
+
+std::optional<ConcurrentStitch::Band> ConcurrentStitch::Solid(Id id,
+                                                              bool claim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = solid_.find(id);
+  if (it == solid_.end()) return std::nullopt;
+  Band band = it->second;
+  if (claim) solid_.erase(it);
+  return band;
+}
+
+// Tiles are only read when they overlap the locked band (so no other
+// mutation may write them), and their stitches are only followed when
+// they lie inside the band.
+
+ConcurrentStitch::Status ConcurrentStitch::Fit(Id id, Band& band) const {
+  const auto& t = s_.Ref(id);
+  Len lo = t.coord.y, hi = t.UpperLeftCorner().y;
+  if (band.lo <= lo && hi <= band.hi) return OK;
+  band = {std::min(band.lo, lo), std::max(band.hi, hi)};
+  return WIDEN;
+}
+
+template <typename F>
+void ConcurrentStitch::ForNeighbors(Id id, F f) const {
+  // as *NeighborFinding, but stop at the last neighbor instead of reading
+  // the tile after it
+  const auto& t = s_.Ref(id);
+  for (Id n = t.tr; n != kNullId; n = s_.Ref(n).lb) {
+    f(n);
+    if (s_.Ref(n).coord.y <= t.coord.y) break;
+  }
+  for (Id n = t.bl; n != kNullId; n = s_.Ref(n).rt) {
+    f(n);
+    if (s_.Ref(n).UpperLeftCorner().y >= t.UpperLeftCorner().y) break;
+  }
+  for (Id n = t.rt; n != kNullId; n = s_.Ref(n).bl) {
+    f(n);
+    if (s_.Ref(n).coord.x <= t.coord.x) break;
+  }
+  for (Id n = t.lb; n != kNullId; n = s_.Ref(n).tr) {
+    f(n);
+    if (s_.Ref(n).LowerRightCorner().x >= t.LowerRightCorner().x) break;
+  }
+}
+
+size_t ConcurrentStitch::DeleteSlots(Id id) const {
+  // each left/right neighbor is split at most twice, and the dead tile once
+  // per right neighbor
+  size_t neighbors = 0;
+  ForNeighbors(id, [&](Id) { neighbors++; });
+  return 2 * neighbors + 4;
+}
+
+ConcurrentStitch::Status ConcurrentStitch::Explore(
+    std::vector<Id> seeds, int depth, Band& band,
+    std::vector<Id>& tiles) const {
+  std::unordered_set<Id> visited(seeds.begin(), seeds.end());
+  tiles = seeds;
+  std::vector<Id> next;
+  for (int k = 0; k <= depth; k++) {
+    // widen the band by all tiles of this step at once
+    Status status = OK;
+    for (auto id : seeds)
+      if (Fit(id, band) == WIDEN) status = WIDEN;
+    if (status != OK || k == depth) return status;
+    next.clear();
+    for (auto id : seeds)
+      ForNeighbors(id, [&](Id n) {
+        if (visited.insert(n).second) next.push_back(n);
+      });
+    tiles.insert(tiles.end(), next.begin(), next.end());
+    seeds.swap(next);
+  }
+  return OK;
+}
+
+ConcurrentStitch::Status ConcurrentStitch::Locate(const Pt& pt, Id start,
+                                                  Band& band,
+                                                  Id& found) const {
+  // as PointFinding, a point on the upper/right plane boundary ends at the
+  // tile touching it
+  for (Id id = start;;) {
+    if (Fit(id, band) == WIDEN) return WIDEN;
+    const auto& t = s_.Ref(id);
+    auto cmp_x = t.CmpX(pt), cmp_y = t.CmpY(pt);
+    Id next = kNullId;
+    if (cmp_y == Tile::GT && t.rt != kNullId)
+      next = t.rt;
+    else if (cmp_y == Tile::LT && t.lb != kNullId)
+      next = t.lb;
+    else if (cmp_x == Tile::GT && t.tr != kNullId)
+      next = t.tr;
+    else if (cmp_x == Tile::LT && t.bl != kNullId)
+      next = t.bl;
+    if (next == kNullId) {
+      found = id;
+      return OK;
+    }
+    id = next;
+  }
+}
+
+ConcurrentStitch::Status ConcurrentStitch::PlanInsert(const Tile& tile,
+                                                      Id hint, Band& band,
+                                                      Id& start,
+                                                      size_t& slots) const {
+  if (auto status = Locate(tile.UpperLeftCorner(), hint, band, start))
+    return status;
+  // the tiles touching the (closed) tile, connected through neighbors
+  auto touch = [&](const Tile& t) {
+    return t.coord.x <= tile.LowerRightCorner().x &&
+           tile.coord.x <= t.LowerRightCorner().x &&
+           t.coord.y <= tile.UpperLeftCorner().y &&
+           tile.coord.y <= t.UpperLeftCorner().y;
+  };
+  std::vector<Id> seeds = {start};
+  std::unordered_set<Id> visited = {start};
+  size_t overlap = 0;
+  for (size_t i = 0; i < seeds.size(); i++) {
+    if (Fit(seeds[i], band) == WIDEN) return WIDEN;
+    const auto& t = s_.Ref(seeds[i]);
+    if (t.Overlap(tile)) {
+      if (!t.is_space) return OVERLAP;
+      overlap++;
+    }
+    ForNeighbors(seeds[i], [&](Id n) {
+      if (touch(s_.Ref(n)) && visited.insert(n).second) seeds.push_back(n);
+    });
+  }
+  // each overlapped strip is split at both sides, and the strips at the top
+  // & bottom are split first
+  slots = 2 * overlap + 4;
+  std::vector<Id> tiles;
+  return Explore(seeds, kInsertDepth, band, tiles);
+}
+
+Id ConcurrentStitch::Insert(const Tile& tile, Id hint) {
+  if (!s_.Plane().Contain(tile)) return kNullId;
+  bool short_of_slots = false;
+  {
+    std::shared_lock<std::shared_mutex> shared(resize_);
+    if (auto h = Solid(hint, false)) {
+      Band band = {std::min(h->lo, tile.coord.y),
+                   std::max(h->hi, tile.UpperLeftCorner().y)};
+      for (;;) {
+        Lock(band);
+        // the hint may have been deleted (& its slot reused) before its
+        // band was locked, it is only read when inside the band
+        h = Solid(hint, false);
+        if (!h || h->lo < band.lo || band.hi < h->hi) {
+          Unlock(band);
+          break;
+        }
+        Band wider = band;
+        Id start = kNullId;
+        size_t slots = 0;
+        auto status = PlanInsert(tile, hint, wider, start, slots);
+        std::vector<size_t> pool;
+        if (status == OK && Take(slots, pool) == 0) {
+          Id id = Run(pool, [&] { return s_.Insert(tile, start); });
+          Give(pool, id);
+          Unlock(band);
+          return id;
+        }
+        Unlock(band);
+        if (status == OVERLAP) return kNullId;
+        if (status == OK) {  // short of free slots
+          short_of_slots = true;
+          break;
+        }
+        retries_++;
+        band = wider;
+      }
+    }
+  }
+  exclusive_++;
+  return Exclusive([&] {
+    if (short_of_slots) Grow(std::max(s_.NumSlots(), kMinSlots));
+    Id id = s_.Insert(tile);
+    std::vector<size_t> pool;
+    Give(pool, id);
+    return id;
+  });
+}
+
+std::optional<Tile> ConcurrentStitch::Delete(Id id) {
+  // claiming the tile takes it out of `solid_`, so of concurrent deletes
+  // only one finds it, & no other mutation writes its extent meanwhile
+  auto claimed = Solid(id, true);
+  if (!claimed) return std::nullopt;
+  bool short_of_slots = false;
+  {
+    std::shared_lock<std::shared_mutex> shared(resize_);
+    Band band = *claimed;
+    for (;;) {
+      Lock(band);
+      Band wider = band;
+      std::vector<Id> tiles;
+      auto status = Explore({id}, kDeleteDepth, wider, tiles);
+      std::vector<size_t> pool;
+      if (status == OK && Take(DeleteSlots(id), pool) == 0) {
+        auto dead = Run(pool, [&] { return s_.Delete(id); });
+        Give(pool);
+        Unlock(band);
+        return dead;
+      }
+      Unlock(band);
+      if (status == OK) {  // short of free slots
+        short_of_slots = true;
+        break;
+      }
+      retries_++;
+      band = wider;
+    }
+  }
+  exclusive_++;
+  return Exclusive([&] {
+    if (short_of_slots) Grow(std::max(s_.NumSlots(), kMinSlots));
+    return s_.Delete(id);
+  });
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// Serves Insert/Delete on one plane from several threads at once.
+// A mutation locks a closed band of y holding the whole extent of every
+// tile within a few neighbor steps of its footprint, which covers all the
+// tiles it reads or writes. The band is found optimistically: walking from
+// a known tile, any tile sticking out of the band widens it and restarts
+// the walk. Mutations in disjoint bands run in parallel on free tile slots
+// reserved beforehand, so the tile storage is never resized meanwhile.
+// Bands span the whole width of the plane: mutations far apart in x still
+// serialize once their bands share a y, and a tall tile (solid, or space
+// between tall solid tiles) widens every band reaching it, so a plane with
+// tall tiles across its rows gains little from threads.
+// Mutations without a hint, or short of free slots, run exclusively.
+// The solid tiles are kept with their bands aside, so a hint or a deleted
+// tile is checked without reading tiles outside a locked band.
+class ConcurrentStitch {
+ public:
+  ConcurrentStitch() = delete;
+  ConcurrentStitch(const ConcurrentStitch&) = delete;
+  // `stitch` must only be mutated through this object while it lives,
+  // touched tracking & the summary are disabled as all mutations share them,
+  // and `reserve` free tile slots are preallocated
+  explicit ConcurrentStitch(Stitch& stitch, size_t reserve = 0);
+
+  // insert `tile` as `Stitch::Insert`, locating it from the solid tile
+  // `hint`, exclusively if no hint
+  Id Insert(const Tile& tile, Id hint = kNullId);
+  // delete the solid tile `id` as `Stitch::Delete`, of concurrent deletes of
+  // the same tile only one returns it
+  std::optional<Tile> Delete(Id id);
+  // preallocate free tile slots until `n` are available, exclusively;
+  // running short of them later doubles the tile storage exclusively
+  void Reserve(size_t n);
+  /* number of mutations run exclusively */
+  size_t NumExclusive() const { return exclusive_; }
+  /* number of restarts caused by widened bands */
+  size_t NumRetries() const { return retries_; }
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  // a closed interval of y
+  struct Band {
+    Len lo, hi;
+    bool Overlap(const Band& b) const { return lo <= b.hi && b.lo <= hi; }
+  };
+  enum Status {
+    OK = 0,
+    WIDEN,    // the band was widened, restart
+    OVERLAP,  // the inserted tile overlaps a solid tile
+  };
+  // neighbor steps from the footprint to the farthest tile written: the
+  // stitches of the neighbors of merged neighbors are fixed (tiles one more
+  // step away are only read, and overlap the band as they touch it)
+  static constexpr int kInsertDepth = 2;  // from the overlapped tiles
+  static constexpr int kDeleteDepth = 3;  // from the deleted tile
+  // free slots kept at least after running short of them, & left over
+  // when reserving slots for a mutation in case it runs out of them
+  static constexpr size_t kMinSlots = 64;
+
+  Stitch& s_;
+  std::shared_mutex resize_;  // held shared by banded mutations
+  std::mutex mutex_;  // guards `bands_`, `solid_` & the free slots
+  std::condition_variable released_;
+  std::vector<Band> bands_;  // locked bands
+  // the solid tiles & their bands, but the ones being deleted
+  std::unordered_map<Id, Band> solid_;
+  std::atomic<size_t> exclusive_{0}, retries_{0};
+
+  void Lock(const Band& band);
+  void Unlock(const Band& band);
+  // take `n` free slots into `pool`, return 0 if success else return 1
+  int Take(size_t n, std::vector<size_t>& pool);
+  // return the slots of `pool`, & record the solid tile `inserted`
+  void Give(std::vector<size_t>& pool, Id inserted = kNullId);
+  // the band of the solid tile `id`, claimed for deletion if `claim`
+  std::optional<Band> Solid(Id id, bool claim);
+  // run `f` on the slots of `pool`
+  template <typename F>
+  auto Run(std::vector<size_t>& pool, F f);
+  // add free slots until `n` are available, return 0
+  int Grow(size_t n);
+  // run `f` while no other mutation runs
+  template <typename F>
+  auto Exclusive(F f);
+  // widen `band` to hold tile `id`, return WIDEN if it was widened
+  Status Fit(Id id, Band& band) const;
+  // call `f` for every neighbor of tile `id` without reading further tiles
+  template <typename F>
+  void ForNeighbors(Id id, F f) const;
+  // the slots needed to delete tile `id`
+  size_t DeleteSlots(Id id) const;
+  // tiles within `depth` neighbor steps from `seeds`, all fitting `band`
+  Status Explore(std::vector<Id> seeds, int depth, Band& band,
+                 std::vector<Id>& tiles) const;
+  // the tile at `pt` walking from tile `start`, all fitting `band`
+  Status Locate(const Pt& pt, Id start, Band& band, Id& found) const;
+  // locate `tile` from `hint`, count the slots needed to insert it
+  Status PlanInsert(const Tile& tile, Id hint, Band& band, Id& start,
+                    size_t& slots) const;
+};
+
+template <typename F>
+auto ConcurrentStitch::Run(std::vector<size_t>& pool, F f) {
+  Stitch::pool_ = &pool;
+  Stitch::pool_lock_ = &mutex_;
+  auto result = f();
+  Stitch::pool_ = nullptr;
+  Stitch::pool_lock_ = nullptr;
+  return result;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "parallel.hpp"
+#include "stitch.hpp"
+
+/* number of windows sized `window` stepped by `step` along `length` */
+static size_t NumWindows(Len length, Len window, Len step) {
+  if (window <= 0 || step <= 0 || length < window) return 0;
+  return (size_t)((length - window) / step) + 1;
+}
+
+/* sorted boundaries of all windows starting from `start` */
+static std::vector<Len> Cuts(Len start, size_t n, Len window, Len step) {
+  std::vector<Len> cuts;
+  for (size_t i = 0; i < n; i++) {
+    cuts.push_back(start + i * step);
+    cuts.push_back(start + i * step + window);
+  }
+  std::sort(cuts.begin(), cuts.end());
+  cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+  return cuts;
+}
+
+Grid Stitch::DensityMap(const Tile& area, const Pt& window, const Pt& step,
+                        size_t threads) const {
+  Grid grid;
+  const Tile plane(coord_, size_);
+  if (!NumTiles() || !area.size.IsSize(area.coord) || !plane.Contain(area))
+    return grid;
+  size_t rows = NumWindows(area.size.y, window.y, step.y),
+         cols = NumWindows(area.size.x, window.x, step.x);
+  if (!rows || !cols) return grid;
+  grid.rows = rows;
+  grid.cols = cols;
+  // window boundaries cut the area into cells,
+  // every window is then a rectangular block of cells
+  auto xs = Cuts(area.coord.x, grid.cols, window.x, step.x);
+  auto ys = Cuts(area.coord.y, grid.rows, window.y, step.y);
+  size_t nx = xs.size() - 1, ny = ys.size() - 1;
+  // solid area of each cell, accumulated by bands of cell rows:
+  // each tile overlapping the band is enumerated once & clipped to cells
+  std::vector<Len> cells(nx * ny, 0);
+  ParallelFor(ny, threads, [&](size_t begin, size_t end, size_t) {
+    if (begin == end) return;
+    Tile band({xs.front(), ys[begin]},
+              {xs.back() - xs.front(), ys[end] - ys[begin]});
+    for (auto id : AreaEnum(band)) {
+      const auto& t = Ref(id);
+      if (t.is_space) continue;
+      Len tx0 = std::max(t.coord.x, xs.front()),
+          tx1 = std::min(t.UpperRightCorner().x, xs.back());
+      Len ty0 = std::max(t.coord.y, ys[begin]),
+          ty1 = std::min(t.UpperRightCorner().y, ys[end]);
+      if (tx0 >= tx1 || ty0 >= ty1) continue;
+      size_t i0 = std::upper_bound(xs.begin(), xs.end(), tx0) - xs.begin() - 1;
+      size_t j0 = std::upper_bound(ys.begin(), ys.end(), ty0) - ys.begin() - 1;
+      for (size_t j = j0; j < end && ys[j] < ty1; j++) {
+        Len h = std::min(ty1, ys[j + 1]) - std::max(ty0, ys[j]);
+        for (size_t i = i0; i < nx && xs[i] < tx1; i++) {
+          Len w = std::min(tx1, xs[i + 1]) - std::max(tx0, xs[i]);
+          cells[j * nx + i] += w * h;
+        }
+      }
+    }
+  });
+  // integral image of cells: sums[j][i] = area of cells below j & left to i
+  std::vector<Len> sums((nx + 1) * (ny + 1), 0);
+  for (size_t j = 0; j < ny; j++)
+    for (size_t i = 0; i < nx; i++)
+      sums[(j + 1) * (nx + 1) + i + 1] = cells[j * nx + i] +
+                                         sums[j * (nx + 1) + i + 1] +
+                                         sums[(j + 1) * (nx + 1) + i] -
+                                         sums[j * (nx + 1) + i];
+  // each window looks up 4 corners of the integral image
+  auto index = [](const std::vector<Len>& cuts, Len v) {
+    return std::lower_bound(cuts.begin(), cuts.end(), v) - cuts.begin();
+  };
+  grid.values.resize(grid.rows * grid.cols);
+  ParallelFor(grid.rows, threads, [&](size_t begin, size_t end, size_t) {
+    for (size_t r = begin; r < end; r++) {
+      size_t j0 = index(ys, area.coord.y + r * step.y),
+             j1 = index(ys, area.coord.y + r * step.y + window.y);
+      for (size_t c = 0; c < grid.cols; c++) {
+        size_t i0 = index(xs, area.coord.x + c * step.x),
+               i1 = index(xs, area.coord.x + c * step.x + window.x);
+        Len solid = sums[j1 * (nx + 1) + i1] - sums[j0 * (nx + 1) + i1] -
+                    sums[j1 * (nx + 1) + i0] + sums[j0 * (nx + 1) + i0];
+        grid.values[r * grid.cols + c] = solid / (window.x * window.y);
+      }
+    }
+  });
+  return grid;
+}
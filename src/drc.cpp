@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "parallel.hpp"
+#include "stitch.hpp"
+
+/* euclidean distance between the closest points of tiles `a` & `b` */
+static Len Distance(const Tile& a, const Tile& b) {
+  Len dx = std::max({Len(0), a.coord.x - (b.coord.x + b.size.x),
+                     b.coord.x - (a.coord.x + a.size.x)});
+  Len dy = std::max({Len(0), a.coord.y - (b.coord.y + b.size.y),
+                     b.coord.y - (a.coord.y + a.size.y)});
+  return std::hypot(dx, dy);
+}
+
+std::vector<Violation> Stitch::SpacingCheck(Len spacing,
+                                            size_t threads) const {
+  auto ids = Tiles();
+  std::vector<std::vector<Violation>> found(NumThreads(threads));
+  ParallelFor(ids.size(), threads, [&](size_t begin, size_t end, size_t t) {
+    std::unordered_set<Id> visited;
+    std::vector<Id> queue;
+    for (size_t i = begin; i < end; i++) {
+      Id src = ids[i];
+      const auto& s = Ref(src);
+      if (s.is_space) continue;
+      // walk the space tiles closer than `spacing` to the solid tile,
+      // solid tiles reached by the walk are the candidates
+      visited = {src};
+      queue = {src};
+      while (queue.size()) {
+        Id id = queue.back();
+        queue.pop_back();
+        if (id != src) {
+          auto d = Distance(s, Ref(id));
+          if (d >= spacing) continue;
+          if (!Ref(id).is_space) {
+            if (d > 0)
+              found[t].push_back({Violation::SPACING, std::min(src, id),
+                                  std::max(src, id), d});
+            continue;  // do not walk through solid tiles
+          }
+        }
+        for (auto n : {RightNeighborFinding(id), TopNeighborFinding(id),
+                       LeftNeighborFinding(id), BottomNeighborFinding(id)})
+          for (auto nid : n)
+            if (visited.insert(nid).second) queue.push_back(nid);
+      }
+    }
+  });
+  // a pair might be found from both of its tiles
+  std::vector<Violation> violations;
+  for (auto& f : found)
+    violations.insert(violations.end(), f.begin(), f.end());
+  std::sort(violations.begin(), violations.end(),
+            [](const Violation& l, const Violation& r) {
+              return std::make_pair(l.a, l.b) < std::make_pair(r.a, r.b);
+            });
+  violations.erase(std::unique(violations.begin(), violations.end()),
+                   violations.end());
+  return violations;
+}
+
+std::vector<Violation> Stitch::WidthCheck(Len width, size_t threads) const {
+  auto ids = Tiles();
+  std::vector<std::vector<Violation>> found(NumThreads(threads));
+  auto all_solid = [&](const std::vector<Id>& neighbors) {
+    if (neighbors.empty()) return false;  // plane boundary
+    for (auto id : neighbors)
+      if (Ref(id).is_space) return false;
+    return true;
+  };
+  ParallelFor(ids.size(), threads, [&](size_t begin, size_t end, size_t t) {
+    for (size_t i = begin; i < end; i++) {
+      Id id = ids[i];
+      const auto& tl = Ref(id);
+      if (!tl.is_space) {
+        auto w = std::min(tl.size.x, tl.size.y);
+        if (w < width) found[t].push_back({Violation::WIDTH, id, kNullId, w});
+        continue;
+      }
+      // a maximal horizontal strip is bounded by solid tiles at left & right
+      if (tl.size.x < width && Exist(tl.bl) && Exist(tl.tr)) {
+        found[t].push_back({Violation::WIDTH, id, kNullId, tl.size.x});
+      } else if (tl.size.y < width &&
+                 all_solid(TopNeighborFinding(id)) &&
+                 all_solid(BottomNeighborFinding(id))) {
+        found[t].push_back({Violation::WIDTH, id, kNullId, tl.size.y});
+      }
+    }
+  });
+  std::vector<Violation> violations;
+  for (auto& f : found)
+    violations.insert(violations.end(), f.begin(), f.end());
+  return violations;
+}
@@ -0,0 +1,87 @@
+#include "dual.hpp"
+
+DualStitch::DualStitch(const Pt& coord, const Pt& size)
+    : h_(coord, size), v_(Transpose(coord), Transpose(size)) {}
+
+Tile DualStitch::Geometry(const Tile& t) {
+  return Tile(t.coord, t.size, t.is_space);
+}
+
+Tile DualStitch::Transpose(const Tile& t) {
+  return Tile(Transpose(t.coord), Transpose(t.size), t.is_space);
+}
+
+std::optional<Tile> DualStitch::HorizontalStrip(const Pt& pt) const {
+  auto t = h_.At(h_.PointFinding(pt));
+  return t.has_value() ? std::optional<Tile>(Geometry(t.value()))
+                       : std::nullopt;
+}
+
+std::optional<Tile> DualStitch::VerticalStrip(const Pt& pt) const {
+  auto t = v_.At(v_.PointFinding(Transpose(pt)));
+  return t.has_value() ? std::optional<Tile>(Transpose(t.value()))
+                       : std::nullopt;
+}
+
+Id DualStitch::AreaSearch(const Tile& area) const {
+  if (!PreferVertical(area)) return h_.AreaSearch(area);
+  Id id = v_.AreaSearch(Transpose(area));
+  return id != kNullId ? v2h_[id] : kNullId;
+}
+
+std::vector<Tile> DualStitch::AreaEnum(const Tile& area) const {
+  std::vector<Tile> tiles;
+  if (!PreferVertical(area)) {
+    for (auto id : h_.AreaEnum(area))
+      tiles.push_back(Geometry(h_.At(id).value()));
+  } else {
+    for (auto id : v_.AreaEnum(Transpose(area)))
+      tiles.push_back(Transpose(v_.At(id).value()));
+  }
+  return tiles;
+}
+
+std::vector<Tile> DualStitch::NeighborFinding(Id id, Stitch::Dir dir) const {
+  std::vector<Tile> tiles;
+  const Tile* t = h_.Get(id);
+  if (!t) return tiles;
+  bool lateral = dir == Stitch::EAST || dir == Stitch::WEST;
+  if (lateral && !t->is_space) {
+    // the right (left) edge is the top (bottom) edge in the transposed plane
+    Id v = h2v_[id];
+    for (auto n : dir == Stitch::EAST ? v_.TopNeighborFinding(v)
+                                      : v_.BottomNeighborFinding(v))
+      tiles.push_back(Transpose(v_.At(n).value()));
+    return tiles;
+  }
+  for (auto n : dir == Stitch::EAST    ? h_.RightNeighborFinding(id)
+                : dir == Stitch::WEST  ? h_.LeftNeighborFinding(id)
+                : dir == Stitch::NORTH ? h_.TopNeighborFinding(id)
+                                       : h_.BottomNeighborFinding(id))
+    tiles.push_back(Geometry(h_.At(n).value()));
+  return tiles;
+}
+
+Id DualStitch::Insert(const Tile& tile) {
+  Id h = h_.Insert(tile);
+  if (h == kNullId) return kNullId;
+  Id v = v_.Insert(Transpose(tile));
+  if (v == kNullId) {  // the planes disagree, keep them unchanged
+    h_.Delete(h);
+    return kNullId;
+  }
+  if (h2v_.size() <= (size_t)h) h2v_.resize(h + 1, kNullId);
+  if (v2h_.size() <= (size_t)v) v2h_.resize(v + 1, kNullId);
+  h2v_[h] = v;
+  v2h_[v] = h;
+  return h;
+}
+
+std::optional<Tile> DualStitch::Delete(Id id) {
+  auto dead = h_.Delete(id);
+  if (!dead.has_value()) return std::nullopt;
+  v_.Delete(h2v_[id]);
+  v2h_[h2v_[id]] = kNullId;
+  h2v_[id] = kNullId;
+  return dead;
+}
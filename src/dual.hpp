@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// A plane maintained together with its transposed companion, whose space
+// tiles are therefore maximal vertical strips. Solid tiles are mirrored in
+// both planes, and are identified by their ids in the horizontal plane.
+// Area & neighbor queries pick the plane cutting the space fewer times;
+// a point has no such preference, so it is looked up in the plane named
+// by the query (HorizontalStrip / VerticalStrip).
+class DualStitch {
+ public:
+  DualStitch() = delete;
+  DualStitch(const DualStitch& dual) = default;
+  DualStitch(const Pt& coord, const Pt& size);
+
+  /* the plane of maximal horizontal strips */
+  const Stitch& Horizontal() const { return h_; }
+  /* the transposed plane (x & y swapped) of maximal vertical strips */
+  const Stitch& Vertical() const { return v_; }
+  /* number of tiles in the horizontal plane */
+  size_t NumTiles() const { return h_.NumTiles(); }
+  // the maximal horizontal strip (or solid tile) at `pt`, without stitches
+  std::optional<Tile> HorizontalStrip(const Pt& pt) const;
+  // the maximal vertical strip (or solid tile) at `pt`, without stitches
+  std::optional<Tile> VerticalStrip(const Pt& pt) const;
+  // find a solid tile in the given area, searching the plane whose strips
+  // are cut fewer times by the area (the vertical one for tall areas)
+  Id AreaSearch(const Tile& area) const;
+  // enumerate all tiles (without stitches) in the area from the cheaper
+  // plane, so the space tiles returned follow the aspect ratio of `area`
+  std::vector<Tile> AreaEnum(const Tile& area) const;
+  // the neighbors (without stitches) along the `dir` edge of tile `id`, in
+  // the order of the *NeighborFinding of `Stitch`; the left & right edges
+  // of a solid tile are read from the vertical plane, where the space along
+  // them is not cut by the tiles beside it
+  std::vector<Tile> NeighborFinding(Id id, Stitch::Dir dir) const;
+  // return the id of the inserted tile if success, else return `kNullId`
+  Id Insert(const Tile& tile);
+  // return the deleted tile if success, else return `std::nullopt`
+  std::optional<Tile> Delete(Id id);
+
+  static Pt Transpose(const Pt& p) { return Pt(p.y, p.x); }
+  // the transposed tile without stitches
+  static Tile Transpose(const Tile& t);
+  // the tile without stitches
+  static Tile Geometry(const Tile& t);
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  Stitch h_, v_;
+  std::vector<Id> h2v_, v2h_;  // ids of mirrored solid tiles
+
+  // the vertical plane is cheaper for areas taller than wide
+  static bool PreferVertical(const Tile& area) {
+    return area.size.y > area.size.x;
+  }
+};
@@ -0,0 +1,135 @@
+#include "stitch.hpp"
+
+int Stitch::Extend(const Pt& coord, const Pt& size) {
+  if (!NumTiles() || !coord.InQuadrantI() || !size.IsSize(coord) ||
+      coord.x > coord_.x || coord.y > coord_.y ||
+      coord.x + size.x < coord_.x + size_.x ||
+      coord.y + size.y < coord_.y + size_.y)
+    return 1;
+  // the corner tiles have no neighbor toward their corner
+  auto corner = [&](bool upper_right) {
+    Id id = LastInserted();
+    for (;;) {
+      const auto& t = Ref(id);
+      Id a = upper_right ? t.tr : t.bl, b = upper_right ? t.rt : t.lb;
+      if (Exist(a))
+        id = a;
+      else if (Exist(b))
+        id = b;
+      else
+        return id;
+    }
+  };
+  // the tiles along the left border from the bottom & along the right
+  // border from the top: step across the corner, then back to the border
+  auto left_border = [&]() {
+    std::vector<Id> ids;
+    for (Id id = corner(false); Exist(id);) {
+      ids.push_back(id);
+      for (id = Ref(id).rt; Exist(id) && Exist(Ref(id).bl);) id = Ref(id).bl;
+    }
+    return ids;
+  };
+  auto right_border = [&]() {
+    std::vector<Id> ids;
+    for (Id id = corner(true); Exist(id);) {
+      ids.push_back(id);
+      for (id = Ref(id).lb; Exist(id) && Exist(Ref(id).tr);) id = Ref(id).tr;
+    }
+    return ids;
+  };
+  auto new_tile = [&](const Pt& coord, const Pt& size) {
+    Id id = AllocTile();
+    Ref(id) = Tile(coord, size);
+    Touch(id);
+    return id;
+  };
+  // left & right: stretch the space tiles, cover each run of solid tiles
+  // by a new space tile
+  if (Len dx = coord_.x - coord.x; dx > 0) {
+    auto ids = left_border();
+    Touch(ids);
+    for (size_t i = 0; i < ids.size();) {
+      auto& t = Ref(ids[i]);
+      if (t.is_space) {
+        t.coord.x -= dx;
+        t.size.x += dx;
+        i++;
+        continue;
+      }
+      size_t j = i;  // the run of solid tiles from the bottom [i, j)
+      while (j < ids.size() && !Ref(ids[j]).is_space) j++;
+      Len top = Ref(ids[j - 1]).UpperLeftCorner().y;
+      Id n = new_tile({coord.x, t.coord.y}, {dx, top - t.coord.y});
+      Ref(n).lb = i ? ids[i - 1] : kNullId;
+      Ref(n).tr = ids[j - 1];
+      Ref(n).rt = j < ids.size() ? ids[j] : kNullId;
+      for (size_t k = i; k < j; k++) Ref(ids[k]).bl = n;
+      if (j < ids.size()) Ref(ids[j]).lb = n;
+      i = j;
+    }
+    coord_.x -= dx;
+    size_.x += dx;
+  }
+  if (Len dx = coord.x + size.x - (coord_.x + size_.x); dx > 0) {
+    auto ids = right_border();
+    Touch(ids);
+    const Len x = coord_.x + size_.x;
+    for (size_t i = 0; i < ids.size();) {
+      auto& t = Ref(ids[i]);
+      if (t.is_space) {
+        t.size.x += dx;
+        i++;
+        continue;
+      }
+      size_t j = i;  // the run of solid tiles from the top [i, j)
+      while (j < ids.size() && !Ref(ids[j]).is_space) j++;
+      Len bottom = Ref(ids[j - 1]).coord.y;
+      Id n = new_tile({x, bottom}, {dx, t.UpperLeftCorner().y - bottom});
+      Ref(n).bl = ids[j - 1];
+      Ref(n).lb = j < ids.size() ? ids[j] : kNullId;
+      Ref(n).rt = i ? ids[i - 1] : kNullId;
+      for (size_t k = i; k < j; k++) Ref(ids[k]).tr = n;
+      if (j < ids.size()) Ref(ids[j]).rt = n;
+      i = j;
+    }
+    size_.x += dx;
+  }
+  // bottom & top: stretch the only space tile along the border, else add a
+  // space tile as wide as the plane
+  if (Len dy = coord_.y - coord.y; dy > 0) {
+    std::vector<Id> ids;  // from the left
+    for (Id id = corner(false); Exist(id);) {
+      ids.push_back(id);
+      for (id = Ref(id).tr; Exist(id) && Exist(Ref(id).lb);) id = Ref(id).lb;
+    }
+    Touch(ids);
+    if (ids.size() == 1 && Ref(ids[0]).is_space) {
+      Ref(ids[0]).coord.y -= dy;
+      Ref(ids[0]).size.y += dy;
+    } else {
+      Id n = new_tile({coord_.x, coord.y}, {size_.x, dy});
+      Ref(n).rt = ids.back();
+      for (auto id : ids) Ref(id).lb = n;
+    }
+    coord_.y -= dy;
+    size_.y += dy;
+  }
+  if (Len dy = coord.y + size.y - (coord_.y + size_.y); dy > 0) {
+    std::vector<Id> ids;  // from the left
+    for (Id id = left_border().back(); Exist(id); id = Ref(id).tr)
+      ids.push_back(id);
+    Touch(ids);
+    if (ids.size() == 1 && Ref(ids[0]).is_space) {
+      Ref(ids[0]).size.y += dy;
+    } else {
+      Id n = new_tile({coord_.x, coord_.y + size_.y}, {size_.x, dy});
+      Ref(n).lb = ids.front();
+      for (auto id : ids) Ref(id).rt = n;
+    }
+    size_.y += dy;
+  }
+  // the summary covers the plane
+  if (summary_) EnableSummary(summary_->Depth());
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include "hierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/* [lo, hi) overlaps [blo, bhi) as in Tile::Overlap, so an empty [lo, lo)
+ * overlaps if `lo` lies inside */
+static bool Overlap(Len lo, Len hi, Len blo, Len bhi) {
+  return blo <= lo ? lo < bhi : blo < hi;
+}
+
+/* the part of `area` moved by -`offset` inside `bounds` */
+static std::optional<Tile> Clip(const Tile& area, const Pt& offset,
+                                const Tile& bounds) {
+  Pt lo = area.coord - offset, hi = area.UpperRightCorner() - offset;
+  const Pt blo = bounds.coord, bhi = bounds.UpperRightCorner();
+  if (!Overlap(lo.x, hi.x, blo.x, bhi.x) || !Overlap(lo.y, hi.y, blo.y, bhi.y))
+    return std::nullopt;
+  lo = Pt(std::max(lo.x, blo.x), std::max(lo.y, blo.y));
+  hi = Pt(std::min(hi.x, bhi.x), std::min(hi.y, bhi.y));
+  return Tile(lo, hi - lo);
+}
+
+Hierarchy::Hierarchy(const Pt& coord, const Pt& size) : top_(coord, size) {}
+
+Hierarchy::CellId Hierarchy::AddCell(Stitch cell) {
+  cells_.push_back(std::move(cell));
+  return cells_.size() - 1;
+}
+
+std::optional<size_t> Hierarchy::Place(CellId cell, const Pt& offset) {
+  if (cell >= cells_.size() || !cells_[cell].NumTiles()) return std::nullopt;
+  const auto plane = cells_[cell].Plane();
+  // a tile must lie in quadrant I, so check the corner before building it
+  if (!(plane.coord + offset).InQuadrantI()) return std::nullopt;
+  Tile bounds(plane.coord + offset, plane.size);
+  if (!top_.Plane().Contain(bounds)) return std::nullopt;
+  instances_.push_back({cell, offset});
+  Len side = std::max(bounds.size.x, bounds.size.y);
+  if (side > bucket_) {
+    // at least double the buckets, so each instance is rehashed O(log) times
+    bucket_ = std::max(side, 2 * bucket_);
+    buckets_.clear();
+    for (size_t i = 0; i < instances_.size(); i++)
+      buckets_[Bucket(Bounds(i).coord)].push_back(i);
+  } else {
+    buckets_[Bucket(bounds.coord)].push_back(instances_.size() - 1);
+  }
+  return instances_.size() - 1;
+}
+
+std::pair<Len, Len> Hierarchy::Bucket(const Pt& pt) const {
+  const auto origin = top_.Plane().coord;
+  return {std::floor((pt.x - origin.x) / bucket_),
+          std::floor((pt.y - origin.y) / bucket_)};
+}
+
+Tile Hierarchy::Bounds(size_t instance) const {
+  const auto& inst = instances_[instance];
+  const auto plane = cells_[inst.cell].Plane();
+  return Tile(plane.coord + inst.offset, plane.size);
+}
+
+template <typename F>
+bool Hierarchy::ForOverlapping(const Tile& area, F f) const {
+  if (buckets_.empty()) return false;
+  // an instance overlapping the area has its lower-left corner less than
+  // `bucket_` left of & below it, walk the nonempty buckets of that range
+  // column by column
+  auto lo = Bucket(area.coord - Pt(bucket_, bucket_)),
+       hi = Bucket(area.UpperRightCorner());
+  auto it = buckets_.lower_bound(lo);
+  while (it != buckets_.end() && it->first.first <= hi.first) {
+    if (it->first.second > hi.second) {  // on to the next column
+      it = buckets_.lower_bound(
+          {it->first.first, std::numeric_limits<Len>::infinity()});
+      continue;
+    }
+    if (it->first.second < lo.second) {
+      it = buckets_.lower_bound({it->first.first, lo.second});
+      continue;
+    }
+    for (auto i : it->second)
+      // instances merely touching the area hold none of it
+      if (Bounds(i).Overlap(area) && f(i)) return true;
+    ++it;
+  }
+  return false;
+}
+
+std::optional<Hierarchy::Hit> Hierarchy::PointFinding(const Pt& pt) const {
+  auto hit = [&](size_t instance, const Stitch& s, const Pt& offset,
+                 const Pt& local) -> std::optional<Hit> {
+    if (!s.NumTiles() || !s.Plane().Contain(local)) return std::nullopt;
+    Id id = s.PointFinding(local);
+    auto t = s.At(id).value_or(Tile());
+    if (t.is_space) return std::nullopt;
+    return Hit{instance, id, Tile(t.coord + offset, t.size, false)};
+  };
+  if (auto h = hit(kTop, top_, {0, 0}, pt)) return h;
+  std::optional<Hit> found;
+  ForOverlapping(Tile(pt, {0, 0}), [&](size_t i) {
+    const auto& inst = instances_[i];
+    found = hit(i, cells_[inst.cell], inst.offset, pt - inst.offset);
+    return found.has_value();
+  });
+  return found;
+}
+
+std::optional<Hierarchy::Hit> Hierarchy::AreaSearch(const Tile& area) const {
+  auto hit = [&](size_t instance, const Stitch& s,
+                 const Pt& offset) -> std::optional<Hit> {
+    if (!s.NumTiles()) return std::nullopt;
+    auto local = Clip(area, offset, s.Plane());
+    if (!local) return std::nullopt;
+    Id id = s.AreaSearch(*local);
+    if (id == kNullId) return std::nullopt;
+    auto t = s.At(id).value();
+    return Hit{instance, id, Tile(t.coord + offset, t.size, false)};
+  };
+  if (auto h = hit(kTop, top_, {0, 0})) return h;
+  std::optional<Hit> found;
+  ForOverlapping(area, [&](size_t i) {
+    const auto& inst = instances_[i];
+    found = hit(i, cells_[inst.cell], inst.offset);
+    return found.has_value();
+  });
+  return found;
+}
+
+std::vector<Hierarchy::Hit> Hierarchy::AreaEnum(const Tile& area) const {
+  std::vector<Hit> hits;
+  auto collect = [&](size_t instance, const Stitch& s, const Pt& offset) {
+    if (!s.NumTiles()) return;
+    auto local = Clip(area, offset, s.Plane());
+    if (!local) return;
+    for (auto id : s.AreaEnum(*local)) {
+      auto t = s.At(id).value();
+      if (!t.is_space)
+        hits.push_back({instance, id, Tile(t.coord + offset, t.size, false)});
+    }
+  };
+  collect(kTop, top_, {0, 0});
+  ForOverlapping(area, [&](size_t i) {
+    const auto& inst = instances_[i];
+    collect(i, cells_[inst.cell], inst.offset);
+    return false;
+  });
+  return hits;
+}
+
+Stitch Hierarchy::Flatten() const {
+  const auto plane = top_.Plane();
+  Stitch flat(plane.coord, plane.size);
+  auto insert = [&](const Stitch& s, const Pt& offset) {
+    for (auto id : s.Tiles()) {
+      auto t = s.At(id).value();
+      if (!t.is_space) flat.Insert(Tile(t.coord + offset, t.size, false));
+    }
+  };
+  insert(top_, {0, 0});
+  for (const auto& inst : instances_) insert(cells_[inst.cell], inst.offset);
+  return flat;
+}
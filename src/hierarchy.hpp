@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// A top plane together with instances of cell planes placed at offsets.
+// Each cell is stored once, and queries descend into the instances they
+// overlap, translating coordinates, instead of flattening the design.
+// Solid tiles of different instances (or of the top plane) may overlap.
+class Hierarchy {
+ public:
+  typedef size_t CellId;
+  // the top plane in place of an instance
+  static constexpr size_t kTop = static_cast<size_t>(-1);
+  struct Instance {
+    CellId cell;
+    Pt offset;  // added to the coordinates of the cell plane
+  };
+  // a solid tile of the top plane or of an instance
+  struct Hit {
+    size_t instance;  // index of the instance, or `kTop`
+    Id id;            // id in the top plane or in the cell plane
+    Tile tile;        // geometry in the top coordinates, without stitches
+    bool operator==(const Hit& h) const {
+      return instance == h.instance && id == h.id && tile == h.tile;
+    }
+  };
+
+  Hierarchy() = delete;
+  Hierarchy(const Hierarchy& hierarchy) = default;
+  Hierarchy(const Pt& coord, const Pt& size);
+
+  /* the flat top plane, solid tiles may be inserted into it directly */
+  Stitch& Top() { return top_; }
+  const Stitch& Top() const { return top_; }
+  /* store `cell` once, return its id */
+  CellId AddCell(Stitch cell);
+  const Stitch& Cell(CellId cell) const { return cells_[cell]; }
+  size_t NumCells() const { return cells_.size(); }
+  // place `cell` at `offset`, return the index of the instance if success,
+  // else (unknown cell or out of the top plane) return `std::nullopt`
+  std::optional<size_t> Place(CellId cell, const Pt& offset);
+  const Instance& At(size_t instance) const { return instances_[instance]; }
+  size_t NumInstances() const { return instances_.size(); }
+  // the plane of the instance in the top coordinates
+  Tile Bounds(size_t instance) const;
+
+  // a solid tile containing `pt`, the top plane first
+  std::optional<Hit> PointFinding(const Pt& pt) const;
+  // a solid tile overlapping `area`, the top plane first
+  std::optional<Hit> AreaSearch(const Tile& area) const;
+  // all solid tiles overlapping `area`
+  std::vector<Hit> AreaEnum(const Tile& area) const;
+  // all solid tiles flattened into one plane, overlapping ones are dropped
+  Stitch Flatten() const;
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  Stitch top_;
+  std::vector<Stitch> cells_;
+  std::vector<Instance> instances_;
+  // instances by the bucket holding their lower-left corner, the buckets
+  // being squares of side `bucket_` over the top plane, which is at least
+  // the largest side of the placed cells: an area looks into the buckets
+  // around it only. Cells far smaller than the largest one crowd into few
+  // buckets, which are then scanned whole (all instances at worst).
+  std::map<std::pair<Len, Len>, std::vector<size_t>> buckets_;
+  Len bucket_{0};
+
+  // the bucket holding `pt`
+  std::pair<Len, Len> Bucket(const Pt& pt) const;
+
+  // call `f(instance)` for instances overlapping `area` until it returns true
+  template <typename F>
+  bool ForOverlapping(const Tile& area, F f) const;
+};
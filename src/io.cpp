@@ -0,0 +1,206 @@
+#include "io.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "parallel.hpp"
+
+// a read-only memory mapped file
+class MappedFile {
+ public:
+  MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      size_ = st.st_size;
+      ok_ = true;
+      if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+          data_ = static_cast<const char*>(data);
+          madvise(data, size_, MADV_SEQUENTIAL);
+        } else {
+          ok_ = false;
+        }
+      }
+    }
+    close(fd);
+  }
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+  }
+  bool Ok() const { return ok_; }
+  const char* Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  bool ok_{false};
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+// a parsed record
+struct Record {
+  size_t record{0};
+  bool ok{false};
+  Tile tile{};
+  std::string label;
+};
+
+/* parse one text line [begin, end) */
+static Record ParseLine(const char* begin, const char* end, size_t line) {
+  Record r;
+  r.record = line;
+  auto skip = [&](const char* p) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+  };
+  Len v[4];
+  const char* p = begin;
+  for (auto& x : v) {
+    p = skip(p);
+    auto [next, ec] = std::from_chars(p, end, x);
+    if (ec != std::errc() || (next < end && *next != ' ' && *next != '\t' &&
+                              *next != '\r'))
+      return r;
+    p = next;
+  }
+  p = skip(p);
+  const char* q = end;
+  while (q > p && (q[-1] == ' ' || q[-1] == '\t' || q[-1] == '\r')) q--;
+  r.label.assign(p, q);
+  r.tile.coord = {v[0], v[1]};
+  r.tile.size = {v[2], v[3]};
+  r.tile.is_space = false;
+  r.ok = true;
+  return r;
+}
+
+/* parse the text lines in [begin, end), numbering from 0 */
+static std::vector<Record> ParseText(const char* begin, const char* end,
+                                     size_t& lines) {
+  std::vector<Record> records;
+  lines = 0;
+  for (const char* p = begin; p < end; lines++) {
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!eol) eol = end;
+    const char* q = p;
+    while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+    if (q < eol && *q != '#') records.push_back(ParseLine(q, eol, lines));
+    p = eol + 1;
+  }
+  return records;
+}
+
+/* insert parsed records into `s` in input order */
+static void InsertRecords(Stitch& s, std::vector<Record>& records,
+                          ImportResult& result) {
+  const Tile plane = s.Plane();
+  for (auto& r : records) {
+    if (!r.ok) {
+      result.errors.push_back({ImportError::PARSE, r.record, {}});
+    } else if (!(r.tile.size.x > 0 && r.tile.size.y > 0)) {
+      // also rejects NaN
+      result.errors.push_back({ImportError::EMPTY, r.record, r.tile});
+    } else if (!r.tile.coord.InQuadrantI() ||
+               !r.tile.size.IsSize(r.tile.coord) || !plane.Contain(r.tile)) {
+      result.errors.push_back({ImportError::OUT_OF_PLANE, r.record, r.tile});
+    } else {
+      Id id = s.Insert(r.tile);
+      if (id == kNullId) {
+        result.errors.push_back({ImportError::OVERLAP, r.record, r.tile});
+      } else {
+        result.ids.push_back(id);
+        result.labels.push_back(std::move(r.label));
+      }
+    }
+  }
+}
+
+ImportResult ImportText(Stitch& s, const std::string& path, size_t threads,
+                        size_t batch) {
+  ImportResult result;
+  MappedFile file(path);
+  if (!file.Ok()) {
+    result.status = 1;
+    return result;
+  }
+  const char *data = file.Data(), *end = data + file.Size();
+  // cut [begin, end) into `n` pieces after line breaks
+  auto cut = [](const char* begin, const char* end, size_t n) {
+    std::vector<const char*> cuts = {begin};
+    for (size_t i = 1; i < n; i++) {
+      const char* p = std::max(cuts.back(), begin + (end - begin) * i / n);
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      cuts.push_back(eol ? eol + 1 : end);
+    }
+    cuts.push_back(end);
+    return cuts;
+  };
+  size_t n = NumThreads(threads), line = 0;
+  for (const char* begin = data; begin < end;) {
+    // the batch ends at the first line break after `batch` bytes
+    const char* p =
+        begin + std::min<size_t>(std::max<size_t>(batch, 1), end - begin) - 1;
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    const char* batch_end = eol ? eol + 1 : end;
+    // parse pieces of the batch in parallel
+    auto pieces = cut(begin, batch_end, n);
+    std::vector<std::vector<Record>> records(n);
+    std::vector<size_t> lines(n, 0);
+    ParallelFor(n, n, [&](size_t b, size_t e, size_t) {
+      for (size_t i = b; i < e; i++)
+        records[i] = ParseText(pieces[i], pieces[i + 1], lines[i]);
+    });
+    // insert in input order
+    for (size_t i = 0; i < n; i++) {
+      for (auto& r : records[i]) r.record += line;
+      line += lines[i];
+      InsertRecords(s, records[i], result);
+    }
+    begin = batch_end;
+  }
+  return result;
+}
+
+ImportResult ImportBinary(Stitch& s, const std::string& path, size_t threads,
+                          size_t batch) {
+  ImportResult result;
+  MappedFile file(path);
+  if (!file.Ok()) {
+    result.status = 1;
+    return result;
+  }
+  const size_t kRecordSize = 4 * sizeof(Len);
+  size_t num = file.Size() / kRecordSize;
+  size_t per_batch = std::max<size_t>(1, batch / kRecordSize);
+  for (size_t first = 0; first < num; first += per_batch) {
+    size_t count = std::min(per_batch, num - first);
+    std::vector<Record> records(count);
+    ParallelFor(count, threads, [&](size_t b, size_t e, size_t) {
+      for (size_t i = b; i < e; i++) {
+        Len v[4];
+        std::memcpy(v, file.Data() + (first + i) * kRecordSize, kRecordSize);
+        auto& r = records[i];
+        r.record = first + i;
+        r.tile.coord = {v[0], v[1]};
+        r.tile.size = {v[2], v[3]};
+        r.tile.is_space = false;
+        r.ok = true;
+      }
+    });
+    InsertRecords(s, records, result);
+  }
+  // trailing bytes of an incomplete record
+  if (file.Size() % kRecordSize)
+    result.errors.push_back({ImportError::PARSE, num, {}});
+  return result;
+}
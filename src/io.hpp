@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// a rectangle rejected by the importer
+struct ImportError {
+  enum Kind {
+    PARSE = 0,     // malformed record
+    OUT_OF_PLANE,  // not inside the plane
+    OVERLAP,       // overlaps solid tiles already in the plane
+    EMPTY,         // width or height not positive
+  };
+  Kind kind{PARSE};
+  size_t record{0};  // 0-based line (text) or record (binary) number
+  Tile tile{};       // the rejected rectangle (unset for `PARSE`)
+};
+
+struct ImportResult {
+  int status{0};                    // 1 if the file cannot be read
+  std::vector<Id> ids;              // inserted tiles in input order
+  std::vector<std::string> labels;  // label of each inserted tile
+  std::vector<ImportError> errors;
+};
+
+// import lines of `x y w h [label]` from the text file `path` into `s`,
+// blank lines & lines starting with '#' are skipped; the file is mapped,
+// parsed by `threads` threads & inserted in batches of `batch` bytes
+ImportResult ImportText(Stitch& s, const std::string& path, size_t threads = 0,
+                        size_t batch = 1 << 24);
+// import records of 4 native doubles `x y w h` from the binary file `path`
+ImportResult ImportBinary(Stitch& s, const std::string& path,
+                          size_t threads = 0, size_t batch = 1 << 24);
@@ -0,0 +1,182 @@
+#include "journal.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+
+#include "bytes.hpp"
+
+static const uint32_t kCheckpointMagic = 0x4b434453;  // "SDCK"
+// bytes of a record: seq, op, tile, id & checksum
+static const size_t kRecordSize = 8 + 1 + 4 * sizeof(Len) + 4 + 4;
+
+/* CRC-32 (IEEE) of [`data`, `data` + `size`) */
+static uint32_t Crc32(const char* data, size_t size) {
+  static const auto table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ uint8_t(data[i])) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffff;
+}
+
+/* write all of `data` to `fd`, return 1 if failed */
+static int WriteAll(int fd, const std::string& data) {
+  for (size_t pos = 0; pos < data.size();) {
+    auto n = write(fd, data.data() + pos, data.size() - pos);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return 1;
+    pos += n;
+  }
+  return 0;
+}
+
+/* the whole content of file `path`, `std::nullopt` if it cannot be read */
+static std::optional<std::string> ReadAll(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return std::nullopt;
+  std::string data;
+  char buf[1 << 16];
+  for (;;) {
+    auto n = read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      close(fd);
+      if (n < 0) return std::nullopt;
+      return data;
+    }
+    data.append(buf, n);
+  }
+}
+
+Journal::Journal(Stitch& stitch, const std::string& dir, size_t group,
+                 size_t checkpoint)
+    : stitch_(stitch),
+      dir_(dir),
+      group_(std::max<size_t>(group, 1)),
+      checkpoint_(checkpoint) {}
+
+Journal::~Journal() {
+  if (fd_ < 0) return;
+  Sync();
+  close(fd_);
+}
+
+int Journal::Open() {
+  if (fd_ >= 0) return 1;
+  if (mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) return 1;
+  fd_ = open((dir_ + "/journal").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd_ < 0) return 1;
+  return Checkpoint();
+}
+
+Id Journal::Insert(const Tile& tile, Id start) {
+  Id id = stitch_.Insert(tile, start);
+  if (id != kNullId) Append(INSERT, tile, id);
+  return id;
+}
+
+std::optional<Tile> Journal::Delete(Id id) {
+  auto tile = stitch_.Delete(id);
+  if (tile) Append(DELETE, *tile, id);
+  return tile;
+}
+
+void Journal::Append(Op op, const Tile& tile, Id id) {
+  size_t begin = pending_.size();
+  ByteWriter w(pending_);
+  w.Put(uint64_t(++seq_));
+  w.Put(uint8_t(op));
+  w.Put(tile);
+  w.Put(int32_t(id));
+  w.Put(Crc32(pending_.data() + begin, pending_.size() - begin));
+  if (++num_pending_ >= group_) Sync();
+  if (checkpoint_ && seq_ - checkpointed_ >= checkpoint_) Checkpoint();
+}
+
+int Journal::Sync() {
+  if (fd_ < 0) return 1;
+  if (pending_.empty()) return 0;
+  if (WriteAll(fd_, pending_) || fdatasync(fd_) != 0) return 1;
+  pending_.clear();
+  num_pending_ = 0;
+  syncs_++;
+  return 0;
+}
+
+int Journal::Checkpoint() {
+  // the pending records are covered by the checkpoint, but keep the journal
+  // complete in case the checkpoint cannot be written
+  if (Sync()) return 1;
+  std::string data;
+  ByteWriter w(data);
+  auto body = stitch_.Serialize();
+  w.Put(kCheckpointMagic);
+  w.Put(uint64_t(seq_));
+  w.Put(uint64_t(body.size()));
+  w.Put(Crc32(body.data(), body.size()));
+  data += body;
+  // replace the checkpoint atomically, the records it covers are skipped
+  // by `Recover` until the journal is emptied
+  auto path = dir_ + "/checkpoint", tmp = path + ".tmp";
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return 1;
+  bool failed = WriteAll(fd, data) || fsync(fd) != 0;
+  close(fd);
+  if (failed || rename(tmp.c_str(), path.c_str()) != 0) return 1;
+  int dir = open(dir_.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir >= 0) {
+    fsync(dir);
+    close(dir);
+  }
+  checkpointed_ = seq_;
+  if (ftruncate(fd_, 0) != 0 || fdatasync(fd_) != 0) return 1;
+  return 0;
+}
+
+std::optional<Stitch> Stitch::Recover(const std::string& dir) {
+  auto data = ReadAll(dir + "/checkpoint");
+  if (!data) return std::nullopt;
+  ByteReader r(data->data(), data->size());
+  auto magic = r.Get<uint32_t>();
+  auto seq = r.Get<uint64_t>();
+  auto size = r.Get<uint64_t>();
+  auto crc = r.Get<uint32_t>();
+  size_t header = 4 + 8 + 8 + 4;
+  if (!r.Ok() || magic != kCheckpointMagic || size != data->size() - header ||
+      crc != Crc32(data->data() + header, size))
+    return std::nullopt;
+  auto s = Deserialize(data->substr(header));
+  if (!s) return std::nullopt;
+  // replay the records after the checkpoint until the first torn one
+  auto journal = ReadAll(dir + "/journal").value_or("");
+  for (size_t pos = 0; pos + kRecordSize <= journal.size();
+       pos += kRecordSize) {
+    const char* record = journal.data() + pos;
+    ByteReader rec(record, kRecordSize);
+    auto rec_seq = rec.Get<uint64_t>();
+    auto op = rec.Get<uint8_t>();
+    auto tile = rec.GetTile();
+    Id id = rec.Get<int32_t>();
+    if (!rec.Ok() || rec.Get<uint32_t>() != Crc32(record, kRecordSize - 4))
+      break;
+    if (rec_seq <= seq) continue;  // covered by the checkpoint
+    if (rec_seq != seq + 1) break;
+    seq = rec_seq;
+    tile.is_space = false;
+    bool ok = op == Journal::INSERT ? s->Insert(tile) == id
+                                    : s->Delete(id).has_value();
+    if (!ok) return std::nullopt;  // the plane diverged from the journal
+  }
+  return s;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "stitch.hpp"
+#include "tile.hpp"
+
+// A write-ahead journal of the mutations of a plane in a directory, read
+// back by `Stitch::Recover`. The directory holds the file `checkpoint`, a
+// checksummed `Stitch::Serialize` of the plane, and the file `journal` of
+// checksummed Insert/Delete records after it. Records are buffered and
+// synced to disk in groups; a crash loses at most the records of the last
+// unsynced group, and a torn record at the end of the journal is ignored.
+// Replaying the records gives the tiles their original ids.
+class Journal {
+ public:
+  // kind of a record
+  enum Op : uint8_t { INSERT = 0, DELETE };
+
+  Journal() = delete;
+  Journal(const Journal&) = delete;
+  // journal the mutations of `stitch` into `dir`, syncing every `group`
+  // records & checkpointing every `checkpoint` records (0: never)
+  Journal(Stitch& stitch, const std::string& dir, size_t group = 64,
+          size_t checkpoint = 0);
+  // sync the pending records
+  ~Journal();
+
+  // create `dir` if missing & start over with a checkpoint of the plane,
+  // return 1 if failed
+  int Open();
+  // insert `tile` as `Stitch::Insert` & journal it if success
+  Id Insert(const Tile& tile, Id start = kNullId);
+  // delete tile `id` as `Stitch::Delete` & journal it if success
+  std::optional<Tile> Delete(Id id);
+  // write & sync the pending records, return 1 if failed
+  int Sync();
+  // replace the checkpoint by the current plane & empty the journal,
+  // return 1 if failed
+  int Checkpoint();
+  /* number of records journaled & disk syncs */
+  size_t NumRecords() const { return seq_; }
+  size_t NumSyncs() const { return syncs_; }
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  Stitch& stitch_;
+  const std::string dir_;
+  const size_t group_, checkpoint_;
+  int fd_{-1};                // the journal file
+  uint64_t seq_{0};           // sequence number of the last record
+  uint64_t checkpointed_{0};  // sequence number covered by the checkpoint
+  std::string pending_;       // records not written yet
+  size_t num_pending_{0};
+  size_t syncs_{0};
+
+  // append a record of `op` on `tile` resulting in tile `id`
+  void Append(Op op, const Tile& tile, Id id);
+};
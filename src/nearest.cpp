@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <queue>
+#include <unordered_set>
+
+#include "stitch.hpp"
+
+/* rectilinear distance from `p` to the closest point of tile `t` */
+static Len Distance(const Pt& p, const Tile& t) {
+  Len dx = std::max({Len(0), t.coord.x - p.x, p.x - (t.coord.x + t.size.x)});
+  Len dy = std::max({Len(0), t.coord.y - p.y, p.y - (t.coord.y + t.size.y)});
+  return dx + dy;
+}
+
+std::vector<std::pair<Id, Len>> Stitch::NearestSolid(const Pt& p,
+                                                     Len max_dist, size_t k,
+                                                     Id start) const {
+  std::vector<std::pair<Id, Len>> found;
+  if (!k || max_dist < 0 || !Plane().Contain(p)) return found;
+  // the tiles crossed by the path from `p` to the closest point of a tile
+  // are at most as far, so tiles are popped in order of distance
+  typedef std::pair<Len, Id> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+  std::unordered_set<Id> visited;
+  Id id = PointFinding(p, start);
+  if (!Exist(id)) return found;
+  queue.push({0, id});
+  visited.insert(id);
+  while (queue.size() && found.size() < k) {
+    auto [d, id] = queue.top();
+    queue.pop();
+    if (!Ref(id).is_space) found.push_back({id, d});
+    for (auto n : {RightNeighbors(id), TopNeighbors(id), LeftNeighbors(id),
+                   BottomNeighbors(id)})
+      for (auto nid : n) {
+        if (!visited.insert(nid).second) continue;
+        auto nd = Distance(p, Ref(nid));
+        if (nd <= max_dist) queue.push({nd, nid});
+      }
+  }
+  return found;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/* number of worker threads to use, `0` means all hardware threads */
+inline size_t NumThreads(size_t threads) {
+  if (threads == 0) threads = std::thread::hardware_concurrency();
+  return std::max<size_t>(threads, 1);
+}
+
+/* call `f(begin, end, t)` on contiguous chunks of [0, `n`) by thread `t` */
+template <typename F>
+void ParallelFor(size_t n, size_t threads, F f) {
+  threads = std::min(NumThreads(threads), std::max<size_t>(n, 1));
+  if (threads == 1) {
+    f(size_t(0), n, size_t(0));
+    return;
+  }
+  std::vector<std::thread> workers;
+  size_t chunk = (n + threads - 1) / threads;
+  for (size_t t = 0; t < threads; t++) {
+    size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+    workers.emplace_back(f, begin, end, t);
+  }
+  for (auto& w : workers) w.join();
+}
@@ -0,0 +1,124 @@
+#include "protocol.hpp"
+
+#include <cstring>
+
+#include "bytes.hpp"
+
+// frames larger than this are rejected
+static const uint32_t kMaxFrame = 1u << 30;
+
+// appends a frame, its length is patched by `End`
+class Writer : public ByteWriter {
+ public:
+  Writer(std::string& out) : ByteWriter(out), begin_(out.size()) {
+    Put(uint32_t(0));
+  }
+  void End() {
+    uint32_t len = out_.size() - begin_ - sizeof(uint32_t);
+    std::memcpy(&out_[begin_], &len, sizeof(len));
+  }
+
+ private:
+  size_t begin_;
+};
+
+/* locate the body of the frame at the front of `data` */
+static FrameStatus Body(const char* data, size_t size, size_t& used) {
+  uint32_t len;
+  if (size < sizeof(len)) return FRAME_INCOMPLETE;
+  std::memcpy(&len, data, sizeof(len));
+  if (len > kMaxFrame) return FRAME_BAD;
+  if (size - sizeof(len) < len) return FRAME_INCOMPLETE;
+  used = sizeof(len) + len;
+  return FRAME_OK;
+}
+
+void Encode(const Request& r, std::string& out) {
+  Writer w(out);
+  w.Put(r.seq);
+  w.Put(uint8_t(r.op));
+  w.Put(r.plane);
+  switch (r.op) {
+    case Request::CREATE:
+    case Request::INSERT:
+    case Request::AREA_SEARCH:
+    case Request::AREA_ENUM:
+      w.Put(r.area);
+      break;
+    case Request::DELETE:
+    case Request::TILE:
+      w.Put(int32_t(r.id));
+      break;
+    case Request::POINT_FIND:
+      w.Put(r.pt.x);
+      w.Put(r.pt.y);
+      break;
+    case Request::DROP:
+      break;
+  }
+  w.End();
+}
+
+void Encode(const Response& r, std::string& out) {
+  Writer w(out);
+  w.Put(r.seq);
+  w.Put(r.status);
+  w.Put(uint32_t(r.ids.size()));
+  for (size_t i = 0; i < r.ids.size(); i++) {
+    w.Put(int32_t(r.ids[i]));
+    w.Put(r.tiles[i]);
+    w.Put(uint8_t(r.tiles[i].is_space));
+  }
+  w.End();
+}
+
+FrameStatus Decode(const char* data, size_t size, size_t& used, Request& r) {
+  size_t n = 0;
+  if (auto status = Body(data, size, n)) return status;
+  ByteReader rd(data + sizeof(uint32_t), n - sizeof(uint32_t));
+  r = Request();
+  r.seq = rd.Get<uint32_t>();
+  auto op = rd.Get<uint8_t>();
+  if (op > Request::AREA_ENUM) return FRAME_BAD;
+  r.op = Request::Op(op);
+  r.plane = rd.GetString();
+  switch (r.op) {
+    case Request::CREATE:
+    case Request::INSERT:
+    case Request::AREA_SEARCH:
+    case Request::AREA_ENUM:
+      r.area = rd.GetTile();
+      break;
+    case Request::DELETE:
+    case Request::TILE:
+      r.id = rd.Get<int32_t>();
+      break;
+    case Request::POINT_FIND:
+      r.pt.x = rd.Get<Len>();
+      r.pt.y = rd.Get<Len>();
+      break;
+    case Request::DROP:
+      break;
+  }
+  if (!rd.Ok() || !rd.Done()) return FRAME_BAD;
+  used = n;
+  return FRAME_OK;
+}
+
+FrameStatus Decode(const char* data, size_t size, size_t& used, Response& r) {
+  size_t n = 0;
+  if (auto status = Body(data, size, n)) return status;
+  ByteReader rd(data + sizeof(uint32_t), n - sizeof(uint32_t));
+  r = Response();
+  r.seq = rd.Get<uint32_t>();
+  r.status = rd.Get<int32_t>();
+  uint32_t count = rd.Get<uint32_t>();
+  for (uint32_t i = 0; i < count && rd.Ok(); i++) {
+    r.ids.push_back(rd.Get<int32_t>());
+    r.tiles.push_back(rd.GetTile());
+    r.tiles.back().is_space = rd.Get<uint8_t>();
+  }
+  if (!rd.Ok() || !rd.Done()) return FRAME_BAD;
+  used = n;
+  return FRAME_OK;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tile.hpp"
+
+// The binary protocol between the plane server and its clients. Every
+// message is a frame of a uint32 body length followed by the body, all in
+// native byte order (the server only listens on a Unix domain socket).
+// Requests may be pipelined; the responses of a connection come back in
+// the order of its requests, tagged with the same `seq`.
+
+struct Request {
+  enum Op : uint8_t {
+    CREATE = 0,   // create the plane `area`
+    DROP,         // drop the plane
+    INSERT,       // insert the solid tile `area`
+    DELETE,       // delete the solid tile `id`
+    TILE,         // get tile `id`
+    POINT_FIND,   // find the tile at `pt`
+    AREA_SEARCH,  // find a solid tile in `area`
+    AREA_ENUM,    // enumerate all tiles in `area`
+  };
+  uint32_t seq{0};
+  Op op{CREATE};
+  std::string plane;  // name of the plane
+  Tile area{};        // CREATE, INSERT, AREA_SEARCH & AREA_ENUM
+  Pt pt{};            // POINT_FIND
+  Id id{kNullId};     // DELETE & TILE
+
+  // the request does not modify planes
+  bool IsRead() const { return op >= TILE; }
+};
+
+struct Response {
+  uint32_t seq{0};
+  int32_t status{0};  // 1 if the plane is missing or the request failed
+  std::vector<Id> ids;
+  std::vector<Tile> tiles;  // geometry of `ids` (without stitches)
+};
+
+enum FrameStatus {
+  FRAME_OK = 0,
+  FRAME_INCOMPLETE,  // more bytes are needed
+  FRAME_BAD,         // malformed frame
+};
+
+// append the frame of `r` to `out`
+void Encode(const Request& r, std::string& out);
+void Encode(const Response& r, std::string& out);
+// decode the frame at the front of [`data`, `data` + `size`), set `used`
+// to its length if success
+FrameStatus Decode(const char* data, size_t size, size_t& used, Request& r);
+FrameStatus Decode(const char* data, size_t size, size_t& used, Response& r);
@@ -28,9 +28,33 @@ PYBIND11_MODULE(MODULE_NAME, m) {
       .def(py::self == py::self)
       .def(py::self != py::self);
 
+  py::enum_<Stitch::BoolOp>(m, "BoolOp")
+      .value("AND", Stitch::AND)
+      .value("OR", Stitch::OR)
+      .value("NOT", Stitch::NOT)
+      .value("XOR", Stitch::XOR);
+
+  py::enum_<Stitch::Axis>(m, "Axis")
+      .value("X", Stitch::X)
+      .value("Y", Stitch::Y);
+
+  py::enum_<Stitch::Dir>(m, "Dir")
+      .value("EAST", Stitch::EAST)
+      .value("NORTH", Stitch::NORTH)
+      .value("WEST", Stitch::WEST)
+      .value("SOUTH", Stitch::SOUTH);
+
+  py::enum_<ImportError::Kind>(m, "ImportError")
+      .value("PARSE", ImportError::PARSE)
+      .value("OUT_OF_PLANE", ImportError::OUT_OF_PLANE)
+      .value("OVERLAP", ImportError::OVERLAP)
+      .value("EMPTY", ImportError::EMPTY);
+
   py::class_<PyTile>(m, "Tile")
       .def(py::init<const PyTile&>())
       .def_property_readonly("exist", &PyTile::Exist)
+      .def_property_readonly("id", &PyTile::GetId)
+      .def_property_readonly("gen", &PyTile::GetGen)
       .def_property_readonly("coord", &PyTile::Coord)
       .def_property_readonly("size", &PyTile::Size)
       .def_property_readonly("is_space", &PyTile::IsSpace)
@@ -42,12 +66,43 @@ PYBIND11_MODULE(MODULE_NAME, m) {
       .def("left_neighbors", &PyTile::LeftNeighborFinding)
       .def("top_neighbors", &PyTile::TopNeighborFinding)
       .def("bottom_neighbors", &PyTile::BottomNeighborFinding)
+      .def("right_neighbors_iter", &PyTile::RightNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("left_neighbors_iter", &PyTile::LeftNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("top_neighbors_iter", &PyTile::TopNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("bottom_neighbors_iter", &PyTile::BottomNeighborIter,
+           py::keep_alive<0, 1>())
       .def("delete", &PyTile::Delete);
 
+  // iterators return themselves, not a copy, from __iter__
+  py::class_<PyNeighborIter>(m, "NeighborIter")
+      .def("__iter__", [](py::object self) { return self; })
+      .def("__next__", &PyNeighborIter::Next);
+
+  py::class_<PyAreaIter>(m, "AreaIter")
+      .def("__iter__", [](py::object self) { return self; })
+      .def("__next__", &PyAreaIter::Next);
+
+  py::class_<PyStitchIter>(m, "StitchIter")
+      .def("__iter__", [](py::object self) { return self; })
+      .def("__next__", &PyStitchIter::Next);
+
   py::class_<PyStitch>(m, "Stitch")
       .def(py::init<const PyStitch&>())
       .def(py::init<const Pt&, const Pt&>())
       .def("__len__", &PyStitch::NumTiles)
+      .def("__iter__", &PyStitch::Iter)
+      .def(py::pickle(&PyStitch::Serialize,
+                      [](const py::bytes& data) {
+                        auto s = PyStitch::Deserialize(data);
+                        if (!s) throw py::value_error("malformed Stitch state");
+                        return std::move(*s);
+                      }))
+      .def("serialize", &PyStitch::Serialize)
+      .def_static("deserialize", &PyStitch::Deserialize)
+      .def("tile", &PyStitch::At)
       .def("pt_find", &PyStitch::PointFinding)
       .def("right_neighbors", &PyStitch::RightNeighborFinding)
       .def("left_neighbors", &PyStitch::LeftNeighborFinding)
@@ -55,8 +110,101 @@ PYBIND11_MODULE(MODULE_NAME, m) {
       .def("bottom_neighbors", &PyStitch::BottomNeighborFinding)
       .def("area_search", &PyStitch::AreaSearch)
       .def("area_enum", &PyStitch::AreaEnum)
+      .def("segment_walk", &PyStitch::SegmentWalk, py::arg("p"),
+           py::arg("length"), py::arg("dir"), py::arg("stop_at_solid") = false)
+      .def("ray_shoot", &PyStitch::RayShoot)
+      .def("nearest_solid", &PyStitch::NearestSolid, py::arg("p"),
+           py::arg("max_dist") = kLenMax, py::arg("k") = 1)
+      .def("right_neighbors_iter", &PyStitch::RightNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("left_neighbors_iter", &PyStitch::LeftNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("top_neighbors_iter", &PyStitch::TopNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("bottom_neighbors_iter", &PyStitch::BottomNeighborIter,
+           py::keep_alive<0, 1>())
+      .def("area_enum_iter", &PyStitch::AreaEnumIter, py::arg("coord"),
+           py::arg("size"), py::arg("start") = py::none(),
+           py::keep_alive<0, 1>())
       .def("insert", &PyStitch::Insert)
-      .def("delete", &PyStitch::Delete);
+      .def("delete", &PyStitch::Delete)
+      .def("extend", &PyStitch::Extend)
+      .def("density_map", &PyStitch::DensityMap, py::arg("coord"),
+           py::arg("size"), py::arg("window"), py::arg("step"),
+           py::arg("threads") = 0)
+      .def("rasterize", &PyStitch::Rasterize, py::arg("origin"),
+           py::arg("pitch"), py::arg("rows"), py::arg("cols"),
+           py::arg("out") = py::none(), py::arg("label") = false,
+           py::arg("threads") = 0)
+      .def("boolean", &PyStitch::Boolean)
+      .def("bloat", &PyStitch::Bloat)
+      .def("shrink", &PyStitch::Shrink)
+      .def("stats", &PyStitch::Stats, py::arg("sliver") = 0,
+           py::arg("samples") = 64)
+      .def("shrink_to_fit", &PyStitch::ShrinkToFit)
+      .def("connected_components", &PyStitch::ConnectedComponents,
+           py::arg("threads") = 0)
+      .def("compact", &PyStitch::Compact, py::arg("axis"),
+           py::arg("spacing") = 0)
+      .def(
+          "__and__",
+          [](const PyStitch& a, const PyStitch& b) {
+            return a.Boolean(b, Stitch::AND);
+          },
+          py::is_operator())
+      .def(
+          "__or__",
+          [](const PyStitch& a, const PyStitch& b) {
+            return a.Boolean(b, Stitch::OR);
+          },
+          py::is_operator())
+      .def(
+          "__sub__",
+          [](const PyStitch& a, const PyStitch& b) {
+            return a.Boolean(b, Stitch::NOT);
+          },
+          py::is_operator())
+      .def(
+          "__xor__",
+          [](const PyStitch& a, const PyStitch& b) {
+            return a.Boolean(b, Stitch::XOR);
+          },
+          py::is_operator())
+      .def("import_file", &PyStitch::Import, py::arg("path"),
+           py::arg("binary") = false, py::arg("threads") = 0)
+      .def("validate", &PyStitch::Validate, py::arg("full") = true)
+      .def("track_touched", &PyStitch::TrackTouched)
+      .def("enable_summary", &PyStitch::EnableSummary, py::arg("depth") = 8)
+      .def("disable_summary", &PyStitch::DisableSummary)
+      .def("spacing_check", &PyStitch::SpacingCheck, py::arg("spacing"),
+           py::arg("threads") = 0)
+      .def("width_check", &PyStitch::WidthCheck, py::arg("width"),
+           py::arg("threads") = 0);
+
+  py::class_<PyDualStitch>(m, "DualStitch")
+      .def(py::init<const PyDualStitch&>())
+      .def(py::init<const Pt&, const Pt&>())
+      .def("__len__", &PyDualStitch::NumTiles)
+      .def("horizontal_strip", &PyDualStitch::HorizontalStrip)
+      .def("vertical_strip", &PyDualStitch::VerticalStrip)
+      .def("area_search", &PyDualStitch::AreaSearch)
+      .def("area_enum", &PyDualStitch::AreaEnum)
+      .def("neighbor_finding", &PyDualStitch::NeighborFinding)
+      .def("insert", &PyDualStitch::Insert)
+      .def("delete", &PyDualStitch::Delete);
+
+  py::class_<PyHierarchy>(m, "Hierarchy")
+      .def(py::init<const PyHierarchy&>())
+      .def(py::init<const Pt&, const Pt&>())
+      .def("top", &PyHierarchy::Top)
+      .def("insert", &PyHierarchy::Insert)
+      .def("add_cell", &PyHierarchy::AddCell)
+      .def("place", &PyHierarchy::Place)
+      .def("num_instances", &PyHierarchy::NumInstances)
+      .def("pt_find", &PyHierarchy::PointFinding)
+      .def("area_search", &PyHierarchy::AreaSearch)
+      .def("area_enum", &PyHierarchy::AreaEnum)
+      .def("flatten", &PyHierarchy::Flatten);
 
 #ifdef GTEST
   m.def("pytest_tiles", &Tiles);
@@ -4,155 +4,313 @@
 
 #include <pybind11/pybind11.h>
 // <pybind11/pybind11.h> must be first
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/stl.h>
 
+#include <memory>
+#include <string>
+
+#include "dual.hpp"
+#include "hierarchy.hpp"
+#include "io.hpp"
 #include "stitch.hpp"
 #include "tile.hpp"
 
+template <typename It>
+class PyTileIter;
+
 class PyTile {
  public:
-  Stitch& s_;
+  std::shared_ptr<Stitch> s_;  // keeps the plane alive
   Id id_;
-  std::optional<Tile> At() const { return s_.At(id_); }
-  std::optional<Tile> At(Id id) const { return s_.At(id); }
-  bool ExistId(Id id) const { return s_.Exist(id); }
+  uint32_t gen_;  // of the slot when the tile was handed out
+  // the tile read in place, `nullptr` if outdated
+  const Tile* Get() const { return Exist() ? s_->Get(id_) : nullptr; }
+  // `id_`, or `kNullId` if outdated
+  Id Live() const { return Exist() ? id_ : kNullId; }
+  std::optional<PyTile> Link(Id id) const {
+    if (s_->Exist(id))
+      return PyTile(s_, id);
+    else
+      return std::nullopt;
+  }
 
  public:
   PyTile() = delete;
-  PyTile(const PyTile& t) : s_(t.s_), id_(t.id_) {}
-  PyTile(Stitch& s, Id id = kNullId) : s_(s), id_(id) {}
+  PyTile(const PyTile& t) = default;
+  PyTile(const std::shared_ptr<Stitch>& s, Id id = kNullId)
+      : s_(s), id_(id), gen_(s->GetHandle(id).gen) {}
 
-  bool Exist() const { return s_.Exist(id_); }
+  // the tile is still there (not deleted even if its id is reused)
+  bool Exist() const { return s_->Valid({id_, gen_}); }
+  Id GetId() const { return id_; }
+  uint32_t GetGen() const { return gen_; }
   std::optional<Pt> Coord() const {
-    auto t = At();
-    return t.has_value() ? std::optional<Pt>(t.value().coord) : std::nullopt;
+    auto t = Get();
+    return t ? std::optional<Pt>(t->coord) : std::nullopt;
   }
   std::optional<Pt> Size() const {
-    auto t = At();
-    return t.has_value() ? std::optional<Pt>(t.value().size) : std::nullopt;
+    auto t = Get();
+    return t ? std::optional<Pt>(t->size) : std::nullopt;
   }
   std::optional<bool> IsSpace() const {
-    auto t = At();
-    return t.has_value() ? std::optional<bool>(t.value().is_space)
-                         : std::nullopt;
+    auto t = Get();
+    return t ? std::optional<bool>(t->is_space) : std::nullopt;
   }
 
   typedef std::optional<PyTile> OptPyTile;
   OptPyTile BL() const {
-    auto t = At();
-    if (t.has_value() && ExistId(t.value().bl))
-      return PyTile(s_, t.value().bl);
-    else
-      return std::nullopt;
+    auto t = Get();
+    return t ? Link(t->bl) : std::nullopt;
   }
   OptPyTile LB() const {
-    auto t = At();
-    if (t.has_value() && ExistId((t.value().lb)))
-      return PyTile(s_, t.value().lb);
-    else
-      return std::nullopt;
+    auto t = Get();
+    return t ? Link(t->lb) : std::nullopt;
   }
   OptPyTile TR() const {
-    auto t = At();
-    if (t.has_value() && ExistId(t.value().tr))
-      return PyTile(s_, t.value().tr);
-    else
-      return std::nullopt;
+    auto t = Get();
+    return t ? Link(t->tr) : std::nullopt;
   }
   OptPyTile RT() const {
-    auto t = At();
-    if (t.has_value() && ExistId(t.value().rt))
-      return PyTile(s_, t.value().rt);
-    else
-      return std::nullopt;
+    auto t = Get();
+    return t ? Link(t->rt) : std::nullopt;
   }
+  // lazy versions of the *NeighborFinding below
+  PyTileIter<Stitch::NeighborIter> RightNeighborIter() const;
+  PyTileIter<Stitch::NeighborIter> LeftNeighborIter() const;
+  PyTileIter<Stitch::NeighborIter> TopNeighborIter() const;
+  PyTileIter<Stitch::NeighborIter> BottomNeighborIter() const;
   std::vector<PyTile> RightNeighborFinding() const {
-    auto ids = s_.RightNeighborFinding(id_);
+    auto ids = s_->RightNeighborFinding(Live());
     std::vector<PyTile> ret;
     ret.reserve(ids.size());
     for (auto id : ids) ret.push_back(PyTile(s_, id));
     return ret;
   }
   std::vector<PyTile> LeftNeighborFinding() const {
-    auto ids = s_.LeftNeighborFinding(id_);
+    auto ids = s_->LeftNeighborFinding(Live());
     std::vector<PyTile> ret;
     ret.reserve(ids.size());
     for (auto id : ids) ret.push_back(PyTile(s_, id));
     return ret;
   }
   std::vector<PyTile> TopNeighborFinding() const {
-    auto ids = s_.TopNeighborFinding(id_);
+    auto ids = s_->TopNeighborFinding(Live());
     std::vector<PyTile> ret;
     ret.reserve(ids.size());
     for (auto id : ids) ret.push_back(PyTile(s_, id));
     return ret;
   }
   std::vector<PyTile> BottomNeighborFinding() const {
-    auto ids = s_.BottomNeighborFinding(id_);
+    auto ids = s_->BottomNeighborFinding(Live());
     std::vector<PyTile> ret;
     ret.reserve(ids.size());
     for (auto id : ids) ret.push_back(PyTile(s_, id));
     return ret;
   }
-  int Delete() { return s_.Delete(id_).has_value() ? 0 : 1; }
+  int Delete() { return s_->Delete(Live()).has_value() ? 0 : 1; }
+};
+
+// a Python iterator lazily turning the ids of a Stitch view into tiles,
+// invalidated by Insert/Delete as the view is
+template <typename It>
+class PyTileIter {
+ public:
+  std::shared_ptr<Stitch> s_;
+  It it_, end_;
+
+ public:
+  PyTileIter(const std::shared_ptr<Stitch>& s, const Stitch::Range<It>& range)
+      : s_(s), it_(range.begin()), end_(range.end()) {}
+  PyTile Next() {
+    if (it_ == end_) throw pybind11::stop_iteration();
+    return PyTile(s_, *it_++);
+  }
+};
+typedef PyTileIter<Stitch::NeighborIter> PyNeighborIter;
+typedef PyTileIter<Stitch::AreaIter> PyAreaIter;
+
+inline PyNeighborIter PyTile::RightNeighborIter() const {
+  return PyNeighborIter(s_, s_->RightNeighbors(Live()));
+}
+inline PyNeighborIter PyTile::LeftNeighborIter() const {
+  return PyNeighborIter(s_, s_->LeftNeighbors(Live()));
+}
+inline PyNeighborIter PyTile::TopNeighborIter() const {
+  return PyNeighborIter(s_, s_->TopNeighbors(Live()));
+}
+inline PyNeighborIter PyTile::BottomNeighborIter() const {
+  return PyNeighborIter(s_, s_->BottomNeighbors(Live()));
+}
+
+// a Python iterator over the tiles of a plane in id order, tiles inserted
+// meanwhile may be skipped
+class PyStitchIter {
+ public:
+  std::shared_ptr<Stitch> s_;
+  size_t next_{0};
+
+ public:
+  PyStitchIter(const std::shared_ptr<Stitch>& s) : s_(s) {}
+  PyTile Next() {
+    while (next_ < s_->NumSlots() && !s_->Exist(next_)) next_++;
+    if (next_ >= s_->NumSlots()) throw pybind11::stop_iteration();
+    return PyTile(s_, next_++);
+  }
 };
 
 typedef std::pair<Len, Len> Len2;
 typedef std::optional<PyTile> OptPyTile;
+namespace py = pybind11;
+// ((n, 2) array of tile ids, (n,) array of measured values)
+typedef std::tuple<py::array_t<Id>, py::array_t<Len>> PyViolations;
+// (kind, record, coord, size) of a rejected rectangle
+typedef std::tuple<ImportError::Kind, size_t, Pt, Pt> PyImportError;
+// (inserted tile ids, labels, errors)
+typedef std::tuple<py::array_t<Id>, std::vector<std::string>,
+                   std::vector<PyImportError>>
+    PyImportResult;
+
+inline PyViolations ToPyViolations(const std::vector<Violation>& violations) {
+  py::array_t<Id> ids({violations.size(), (size_t)2});
+  py::array_t<Len> values(violations.size());
+  auto i = ids.mutable_unchecked<2>();
+  auto v = values.mutable_unchecked<1>();
+  for (size_t k = 0; k < violations.size(); k++) {
+    i(k, 0) = violations[k].a;
+    i(k, 1) = violations[k].b;
+    v(k) = violations[k].value;
+  }
+  return {ids, values};
+}
 
 class PyStitch {
  public:
-  Stitch s_;
+  std::shared_ptr<Stitch> s_;  // shared with the tiles & iterators
 
  public:
   PyStitch() = delete;
-  PyStitch(const PyStitch& s) : s_(s.s_) {}
-  PyStitch(const Pt& coord, const Pt& size) : s_(coord, size) {}
+  PyStitch(const PyStitch& s) : s_(std::make_shared<Stitch>(*s.s_)) {}
+  PyStitch(const Pt& coord, const Pt& size)
+      : s_(std::make_shared<Stitch>(coord, size)) {}
+  PyStitch(Stitch&& s) : s_(std::make_shared<Stitch>(std::move(s))) {}
 
-  size_t NumTiles() const { return s_.NumTiles(); }
+  size_t NumTiles() const { return s_->NumTiles(); }
+  PyStitchIter Iter() const { return PyStitchIter(s_); }
+  // the plane as `Stitch::Serialize` bytes, also the pickled state
+  py::bytes Serialize() const {
+    std::string data;
+    {
+      py::gil_scoped_release release;
+      data = s_->Serialize();
+    }
+    return py::bytes(data);
+  }
+  static std::optional<PyStitch> Deserialize(const py::bytes& data) {
+    std::string raw = data;
+    std::optional<Stitch> s;
+    {
+      py::gil_scoped_release release;
+      s = Stitch::Deserialize(raw);
+    }
+    if (!s) return std::nullopt;
+    return PyStitch(std::move(*s));
+  }
+  OptPyTile At(Id id) {
+    if (s_->Exist(id))
+      return PyTile(s_, id);
+    else
+      return std::nullopt;
+  }
 
   OptPyTile PointFinding(const Pt& pt, const OptPyTile& start = std::nullopt) {
-    Id id = start.has_value() ? s_.PointFinding(pt, start.value().id_)
-                              : s_.PointFinding(pt);
-    if (s_.Exist(id))
+    Id id = start.has_value() ? s_->PointFinding(pt, start.value().id_)
+                              : s_->PointFinding(pt);
+    if (s_->Exist(id))
       return PyTile(s_, id);
     else
       return std::nullopt;
   }
   std::vector<PyTile> RightNeighborFinding(const PyTile& t) const {
-    if (&t.s_ != &s_) return {};
+    if (t.s_ != s_) return {};
     return t.RightNeighborFinding();
   }
   std::vector<PyTile> LeftNeighborFinding(const PyTile& t) const {
-    if (&t.s_ != &s_) return {};
+    if (t.s_ != s_) return {};
     return t.LeftNeighborFinding();
   }
   std::vector<PyTile> TopNeighborFinding(const PyTile& t) const {
-    if (&t.s_ != &s_) return {};
+    if (t.s_ != s_) return {};
     return t.TopNeighborFinding();
   }
   std::vector<PyTile> BottomNeighborFinding(const PyTile& t) const {
-    if (&t.s_ != &s_) return {};
+    if (t.s_ != s_) return {};
     return t.BottomNeighborFinding();
   }
   OptPyTile AreaSearch(const Pt& coord, const Pt& size,
                        const OptPyTile& start = std::nullopt) {
     if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
     Tile area(coord, size);
-    Id id = start.has_value() ? s_.AreaSearch(area, start.value().id_)
-                              : s_.AreaSearch(area);
-    if (s_.Exist(id))
+    Id id = start.has_value() ? s_->AreaSearch(area, start.value().id_)
+                              : s_->AreaSearch(area);
+    if (s_->Exist(id))
       return PyTile(s_, id);
     else
       return std::nullopt;
   }
+  std::vector<PyTile> SegmentWalk(const Pt& p, Len length, Stitch::Dir dir,
+                                  bool stop_at_solid = false) {
+    std::vector<PyTile> ret;
+    for (auto id : s_->SegmentWalk(p, length, dir, stop_at_solid))
+      ret.push_back(PyTile(s_, id));
+    return ret;
+  }
+  OptPyTile RayShoot(const Pt& p, Stitch::Dir dir) {
+    Id id = s_->RayShoot(p, dir);
+    if (s_->Exist(id))
+      return PyTile(s_, id);
+    else
+      return std::nullopt;
+  }
+  std::vector<std::pair<PyTile, Len>> NearestSolid(const Pt& p,
+                                                   Len max_dist = kLenMax,
+                                                   size_t k = 1) {
+    std::vector<std::pair<PyTile, Len>> ret;
+    for (const auto& [id, d] : s_->NearestSolid(p, max_dist, k))
+      ret.push_back({PyTile(s_, id), d});
+    return ret;
+  }
+  std::optional<PyAreaIter> AreaEnumIter(const Pt& coord, const Pt& size,
+                                         const OptPyTile& start = std::nullopt) {
+    if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
+    Tile area(coord, size);
+    return PyAreaIter(s_, start.has_value()
+                              ? s_->AreaTiles(area, start.value().id_)
+                              : s_->AreaTiles(area));
+  }
+  std::optional<PyNeighborIter> RightNeighborIter(const PyTile& t) const {
+    if (t.s_ != s_) return std::nullopt;
+    return t.RightNeighborIter();
+  }
+  std::optional<PyNeighborIter> LeftNeighborIter(const PyTile& t) const {
+    if (t.s_ != s_) return std::nullopt;
+    return t.LeftNeighborIter();
+  }
+  std::optional<PyNeighborIter> TopNeighborIter(const PyTile& t) const {
+    if (t.s_ != s_) return std::nullopt;
+    return t.TopNeighborIter();
+  }
+  std::optional<PyNeighborIter> BottomNeighborIter(const PyTile& t) const {
+    if (t.s_ != s_) return std::nullopt;
+    return t.BottomNeighborIter();
+  }
   std::vector<PyTile> AreaEnum(const Pt& coord, const Pt& size,
                                const OptPyTile& start = std::nullopt) {
     if (!coord.InQuadrantI() || !size.IsSize()) return {};
     Tile area(coord, size);
-    auto ids = start.has_value() ? s_.AreaEnum(area, start.value().id_)
-                                 : s_.AreaEnum(area);
+    auto ids = start.has_value() ? s_->AreaEnum(area, start.value().id_)
+                                 : s_->AreaEnum(area);
     std::vector<PyTile> ret;
     ret.reserve(ids.size());
     for (auto id : ids) ret.push_back(PyTile(s_, id));
@@ -160,18 +318,257 @@ class PyStitch {
   }
   OptPyTile Insert(const Pt& coord, const Pt& size) {
     if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
-    Id id = s_.Insert({coord, size});
-    if (s_.Exist(id))
+    Id id = s_->Insert({coord, size});
+    if (s_->Exist(id))
       return PyTile(s_, id);
     else
       return std::nullopt;
   }
   int Delete(PyTile& dead) {
-    if (&dead.s_ != &s_)
+    if (dead.s_ != s_)
       return 1;
     else
       return dead.Delete();
   }
+  py::array_t<Len> DensityMap(const Pt& coord, const Pt& size,
+                              const Pt& window, const Pt& step,
+                              size_t threads = 0) const {
+    if (!coord.InQuadrantI() || !size.IsSize()) return py::array_t<Len>();
+    Grid grid;
+    {
+      py::gil_scoped_release release;
+      grid = s_->DensityMap({coord, size}, window, step, threads);
+    }
+    py::array_t<Len> map({grid.rows, grid.cols});
+    std::copy(grid.values.begin(), grid.values.end(), map.mutable_data());
+    return map;
+  }
+  // rasterize into `out` in place (a writable, C-contiguous (rows, cols)
+  // uint8/uint32 buffer) or into a newly allocated array, None if the
+  // buffer is not such or its labels would wrap around
+  std::optional<py::array> Rasterize(const Pt& origin, Len pitch, size_t rows,
+                                     size_t cols,
+                                     std::optional<py::array> out,
+                                     bool label = false, size_t threads = 0) {
+    if (!out) {
+      if (label)
+        out = py::array_t<uint32_t>({rows, cols});
+      else
+        out = py::array_t<uint8_t>({rows, cols});
+    }
+    if (out->ndim() != 2 || (size_t)out->shape(0) != rows ||
+        (size_t)out->shape(1) != cols || !out->writeable() ||
+        !(out->flags() & py::array::c_style))
+      return std::nullopt;
+    void* pixels = out->mutable_data();
+    bool u8 = out->dtype().is(py::dtype::of<uint8_t>()),
+         u32 = out->dtype().is(py::dtype::of<uint32_t>());
+    if (!u8 && !u32) return std::nullopt;
+    int err;
+    {
+      py::gil_scoped_release release;
+      if (u8)
+        err = s_->Rasterize(origin, pitch, rows, cols, (uint8_t*)pixels,
+                            label, threads);
+      else
+        err = s_->Rasterize(origin, pitch, rows, cols, (uint32_t*)pixels,
+                            label, threads);
+    }
+    return err ? std::nullopt : std::optional<py::array>(out);
+  }
+  PyStitch Boolean(const PyStitch& b, Stitch::BoolOp op) const {
+    py::gil_scoped_release release;
+    return PyStitch(Stitch::Boolean(*s_, *b.s_, op));
+  }
+  int Extend(const Pt& coord, const Pt& size) {
+    return s_->Extend(coord, size);
+  }
+  PyStitch Bloat(Len d) const {
+    py::gil_scoped_release release;
+    return PyStitch(s_->Bloat(d));
+  }
+  PyStitch Shrink(Len d) const {
+    py::gil_scoped_release release;
+    return PyStitch(s_->Shrink(d));
+  }
+  void ShrinkToFit() { s_->ShrinkToFit(); }
+  py::dict Stats(Len sliver = 0, size_t samples = 64) const {
+    PlaneStats st;
+    {
+      py::gil_scoped_release release;
+      st = s_->Stats(sliver, samples);
+    }
+    py::dict d;
+    d["solid"] = st.solid;
+    d["space"] = st.space;
+    d["slivers"] = st.slivers;
+    d["area_histogram"] = st.area_histogram;
+    d["aspect_histogram"] = st.aspect_histogram;
+    d["mean_walk"] = st.mean_walk;
+    d["slots"] = st.slots;
+    d["free_slots"] = st.free_slots;
+    d["tiles_bytes"] = st.tiles_bytes;
+    d["slots_bytes"] = st.slots_bytes;
+    d["wasted_bytes"] = st.wasted_bytes;
+    return d;
+  }
+  // the component of each tile id as `Stitch::ConnectedComponents`
+  py::array_t<Id> ConnectedComponents(size_t threads = 0) const {
+    std::vector<Id> components;
+    {
+      py::gil_scoped_release release;
+      components = s_->ConnectedComponents(nullptr, threads);
+    }
+    py::array_t<Id> ret(components.size());
+    std::copy(components.begin(), components.end(), ret.mutable_data());
+    return ret;
+  }
+  PyStitch Compact(Stitch::Axis axis, Len spacing = 0) const {
+    py::gil_scoped_release release;
+    return PyStitch(s_->Compact(axis, spacing));
+  }
+  std::optional<PyImportResult> Import(const std::string& path,
+                                      bool binary = false,
+                                      size_t threads = 0) {
+    ImportResult r;
+    {
+      py::gil_scoped_release release;
+      r = binary ? ImportBinary(*s_, path, threads)
+                 : ImportText(*s_, path, threads);
+    }
+    if (r.status) return std::nullopt;
+    py::array_t<Id> ids(r.ids.size());
+    std::copy(r.ids.begin(), r.ids.end(), ids.mutable_data());
+    std::vector<PyImportError> errors;
+    for (const auto& e : r.errors)
+      errors.push_back({e.kind, e.record, e.tile.coord, e.tile.size});
+    return PyImportResult{ids, r.labels, errors};
+  }
+  std::vector<Id> Validate(bool full = true) const {
+    py::gil_scoped_release release;
+    return full ? s_->Validate() : s_->ValidateTouched();
+  }
+  void TrackTouched(bool enable) { s_->TrackTouched(enable); }
+  void EnableSummary(int depth = 8) { s_->EnableSummary(depth); }
+  void DisableSummary() { s_->DisableSummary(); }
+  PyViolations SpacingCheck(Len spacing, size_t threads = 0) const {
+    std::vector<Violation> violations;
+    {
+      py::gil_scoped_release release;
+      violations = s_->SpacingCheck(spacing, threads);
+    }
+    return ToPyViolations(violations);
+  }
+  PyViolations WidthCheck(Len width, size_t threads = 0) const {
+    std::vector<Violation> violations;
+    {
+      py::gil_scoped_release release;
+      violations = s_->WidthCheck(width, threads);
+    }
+    return ToPyViolations(violations);
+  }
+};
+
+// (coord, size, is_space) of a tile
+typedef std::tuple<Pt, Pt, bool> PyRect;
+
+class PyDualStitch {
+ public:
+  DualStitch d_;
+
+  static PyRect ToPyRect(const Tile& t) {
+    return {t.coord, t.size, t.is_space};
+  }
+
+ public:
+  PyDualStitch() = delete;
+  PyDualStitch(const PyDualStitch& d) : d_(d.d_) {}
+  PyDualStitch(const Pt& coord, const Pt& size) : d_(coord, size) {}
+
+  size_t NumTiles() const { return d_.NumTiles(); }
+  std::optional<PyRect> HorizontalStrip(const Pt& pt) const {
+    auto t = d_.HorizontalStrip(pt);
+    return t.has_value() ? std::optional<PyRect>(ToPyRect(t.value()))
+                         : std::nullopt;
+  }
+  std::optional<PyRect> VerticalStrip(const Pt& pt) const {
+    auto t = d_.VerticalStrip(pt);
+    return t.has_value() ? std::optional<PyRect>(ToPyRect(t.value()))
+                         : std::nullopt;
+  }
+  std::optional<Id> AreaSearch(const Pt& coord, const Pt& size) const {
+    if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
+    Id id = d_.AreaSearch({coord, size});
+    return id != kNullId ? std::optional<Id>(id) : std::nullopt;
+  }
+  std::vector<PyRect> AreaEnum(const Pt& coord, const Pt& size) const {
+    if (!coord.InQuadrantI() || !size.IsSize()) return {};
+    std::vector<PyRect> ret;
+    for (const auto& t : d_.AreaEnum({coord, size}))
+      ret.push_back(ToPyRect(t));
+    return ret;
+  }
+  std::vector<PyRect> NeighborFinding(Id id, Stitch::Dir dir) const {
+    std::vector<PyRect> ret;
+    for (const auto& t : d_.NeighborFinding(id, dir))
+      ret.push_back(ToPyRect(t));
+    return ret;
+  }
+  std::optional<Id> Insert(const Pt& coord, const Pt& size) {
+    if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
+    Id id = d_.Insert({coord, size});
+    return id != kNullId ? std::optional<Id>(id) : std::nullopt;
+  }
+  int Delete(Id id) { return d_.Delete(id).has_value() ? 0 : 1; }
+};
+
+// (instance or None for the top plane, id, (coord, size, is_space))
+typedef std::tuple<std::optional<size_t>, Id, PyRect> PyHit;
+
+class PyHierarchy {
+ public:
+  Hierarchy h_;
+
+  static PyHit ToPyHit(const Hierarchy::Hit& hit) {
+    return {hit.instance != Hierarchy::kTop
+                ? std::optional<size_t>(hit.instance)
+                : std::nullopt,
+            hit.id, PyRect{hit.tile.coord, hit.tile.size, hit.tile.is_space}};
+  }
+
+ public:
+  PyHierarchy() = delete;
+  PyHierarchy(const PyHierarchy& h) : h_(h.h_) {}
+  PyHierarchy(const Pt& coord, const Pt& size) : h_(coord, size) {}
+
+  PyStitch Top() const { return PyStitch(Stitch(h_.Top())); }
+  std::optional<Id> Insert(const Pt& coord, const Pt& size) {
+    if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
+    Id id = h_.Top().Insert({coord, size});
+    return id != kNullId ? std::optional<Id>(id) : std::nullopt;
+  }
+  size_t AddCell(const PyStitch& cell) { return h_.AddCell(*cell.s_); }
+  std::optional<size_t> Place(size_t cell, const Pt& offset) {
+    return h_.Place(cell, offset);
+  }
+  size_t NumInstances() const { return h_.NumInstances(); }
+  std::optional<PyHit> PointFinding(const Pt& pt) const {
+    auto hit = h_.PointFinding(pt);
+    return hit ? std::optional<PyHit>(ToPyHit(*hit)) : std::nullopt;
+  }
+  std::optional<PyHit> AreaSearch(const Pt& coord, const Pt& size) const {
+    if (!coord.InQuadrantI() || !size.IsSize()) return std::nullopt;
+    auto hit = h_.AreaSearch({coord, size});
+    return hit ? std::optional<PyHit>(ToPyHit(*hit)) : std::nullopt;
+  }
+  std::vector<PyHit> AreaEnum(const Pt& coord, const Pt& size) const {
+    if (!coord.InQuadrantI() || !size.IsSize()) return {};
+    std::vector<PyHit> ret;
+    for (const auto& hit : h_.AreaEnum({coord, size}))
+      ret.push_back(ToPyHit(hit));
+    return ret;
+  }
+  PyStitch Flatten() const { return PyStitch(h_.Flatten()); }
 };
 
 #endif
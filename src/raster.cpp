@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "parallel.hpp"
+#include "stitch.hpp"
+
+template <typename T>
+int Stitch::Rasterize(const Pt& origin, Len pitch, size_t rows, size_t cols,
+                      T* pixels, bool label, size_t threads) const {
+  // labels wrap around past the largest id + 1 of a narrow T
+  if (label && NumSlots() > std::numeric_limits<T>::max()) return 1;
+  if (!rows || !cols || pitch <= 0) return 0;
+  std::fill_n(pixels, rows * cols, T(0));
+  if (!NumTiles()) return 0;
+  const Tile plane(coord_, size_);
+  // index of the first pixel whose center is not lower than `v`
+  auto first = [pitch](Len v, Len o, size_t n) {
+    Len i = std::ceil((v - o) / pitch - 0.5);
+    return (size_t)std::clamp<Len>(i, 0, n);
+  };
+  // the size from `lo` to `hi`, not passing `hi` once added to `lo`
+  auto span = [](Len lo, Len hi) {
+    Len size = hi - lo;
+    return lo + size > hi ? std::nextafter(size, Len(0)) : size;
+  };
+  ParallelFor(rows, threads, [&](size_t begin, size_t end, size_t) {
+    if (begin == end) return;
+    // the band from the first pixel centers to the pixel edges past the last
+    // ones (AreaEnum is half-open), clipped by the plane
+    Len x0 = std::max(origin.x + pitch / 2, plane.coord.x),
+        x1 = std::min(origin.x + cols * pitch, plane.UpperRightCorner().x);
+    Len y0 = std::max(origin.y + (begin + 0.5) * pitch, plane.coord.y),
+        y1 = std::min(origin.y + end * pitch, plane.UpperRightCorner().y);
+    if (x0 >= x1 || y0 >= y1) return;
+    for (auto id : AreaEnum({{x0, y0}, {span(x0, x1), span(y0, y1)}})) {
+      const auto& t = Ref(id);
+      if (t.is_space) continue;
+      T value = label ? T(id + 1) : T(1);
+      size_t c0 = first(t.coord.x, origin.x, cols),
+             c1 = first(t.UpperRightCorner().x, origin.x, cols);
+      size_t r0 = std::max(begin, first(t.coord.y, origin.y, rows)),
+             r1 = std::min(end, first(t.UpperRightCorner().y, origin.y, rows));
+      for (size_t r = r0; r < r1; r++)
+        std::fill(pixels + r * cols + c0, pixels + r * cols + c1, value);
+    }
+  });
+  return 0;
+}
+
+template int Stitch::Rasterize<uint8_t>(const Pt&, Len, size_t, size_t,
+                                        uint8_t*, bool, size_t) const;
+template int Stitch::Rasterize<uint32_t>(const Pt&, Len, size_t, size_t,
+                                         uint32_t*, bool, size_t) const;
@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "bytes.hpp"
+#include "stitch.hpp"
+
+static const uint32_t kMagic = 0x48435453;  // "STCH"
+static const uint32_t kVersion = 3;
+
+std::string Stitch::Serialize() const {
+  std::string out;
+  ByteWriter w(out);
+  w.Put(kMagic);
+  w.Put(kVersion);
+  w.Put(Tile(coord_, size_));
+  w.Put(uint64_t(tiles_.Size()));
+  for (size_t i = 0; i < tiles_.Size(); i++) {
+    w.Put(uint8_t(tiles_.Has(i)));
+    if (!tiles_.Has(i)) continue;
+    const auto& t = tiles_[i];
+    w.Put(t);
+    for (Id id : {t.bl, t.lb, t.tr, t.rt}) w.Put(int32_t(id));
+    w.Put(uint8_t(t.is_space));
+  }
+  // free slots in the order they are handed out
+  for (const auto& slots : {tiles_.FreeList(), tiles_.Released()}) {
+    w.Put(uint64_t(slots.size()));
+    for (auto slot : slots) w.Put(uint64_t(slot));
+  }
+  // generations, so handles stay valid
+  for (size_t i = 0; i < tiles_.Size(); i++) w.Put(tiles_.Gen(i));
+  w.Put(tiles_.GenFloor());
+  w.Put(int32_t(last_inserted_));
+  w.Put(int32_t(summary_ ? summary_->Depth() : -1));
+  return out;
+}
+
+std::optional<Stitch> Stitch::Deserialize(const std::string& data) {
+  ByteReader r(data.data(), data.size());
+  if (r.Get<uint32_t>() != kMagic || r.Get<uint32_t>() != kVersion)
+    return std::nullopt;
+  auto plane = r.GetTile();
+  auto n = r.Get<uint64_t>();
+  // every tile takes at least one byte
+  if (!r.Ok() || n > data.size()) return std::nullopt;
+  Stitch s;
+  s.coord_ = plane.coord;
+  s.size_ = plane.size;
+  std::vector<std::optional<Tile>> tiles(n);
+  auto valid = [&](Id id) {
+    return id == kNullId || (0 <= id && size_t(id) < n);
+  };
+  for (auto& t : tiles) {
+    if (!r.Get<uint8_t>()) continue;
+    t = r.GetTile();
+    for (Id* id : {&t->bl, &t->lb, &t->tr, &t->rt}) {
+      *id = r.Get<int32_t>();
+      if (!valid(*id)) return std::nullopt;
+    }
+    t->is_space = r.Get<uint8_t>();
+    if (!r.Ok()) return std::nullopt;
+  }
+  std::vector<size_t> slots[2];  // free list & released chunks
+  for (auto& v : slots) {
+    auto m = r.Get<uint64_t>();
+    if (!r.Ok() || m > n) return std::nullopt;
+    for (uint64_t i = 0; i < m && r.Ok(); i++) v.push_back(r.Get<uint64_t>());
+  }
+  std::vector<uint32_t> gens(n);
+  for (auto& gen : gens) gen = r.Get<uint32_t>();
+  auto gen_floor = r.Get<uint32_t>();
+  s.last_inserted_ = r.Get<int32_t>();
+  int depth = r.Get<int32_t>();
+  if (!r.Ok() || !r.Done() || !valid(s.last_inserted_)) return std::nullopt;
+  if (depth < -1 || depth > Summary::kMaxDepth) return std::nullopt;
+  auto store = TileStore::Restore(tiles, slots[0], slots[1], gens, gen_floor);
+  if (!store) return std::nullopt;
+  s.tiles_ = std::move(*store);
+  if (depth >= 0) s.EnableSummary(depth);
+  return s;
+}
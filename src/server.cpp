@@ -0,0 +1,282 @@
+#include "server.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "parallel.hpp"
+
+// bytes read per `read` call
+static const size_t kReadChunk = 1 << 16;
+// runs of reads shorter than this are not split over threads
+static const size_t kMinParallelReads = 64;
+
+/* make `fd` non-blocking */
+static void SetNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/* append tile `id` of `s` to `res` */
+static void AddTile(const Stitch& s, Id id, Response& res) {
+  auto t = s.At(id);
+  if (!t) return;
+  res.ids.push_back(id);
+  res.tiles.push_back(Tile(t->coord, t->size, t->is_space));
+}
+
+/* the part of `area` inside `plane`, `std::nullopt` if none */
+static std::optional<Tile> Clip(const Tile& area, const Tile& plane) {
+  Pt lo(std::max(area.coord.x, plane.coord.x),
+        std::max(area.coord.y, plane.coord.y));
+  Pt hi(std::min(area.UpperRightCorner().x, plane.UpperRightCorner().x),
+        std::min(area.UpperRightCorner().y, plane.UpperRightCorner().y));
+  if (hi.x <= lo.x || hi.y <= lo.y) return std::nullopt;
+  return Tile(lo, hi - lo);
+}
+
+Server::Server(const std::string& path, size_t threads)
+    : path_(path), threads_(NumThreads(threads)) {}
+
+Server::~Server() {
+  for (auto& conn : conns_) close(conn.fd);
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    unlink(path_.c_str());
+  }
+  for (int fd : wake_)
+    if (fd >= 0) close(fd);
+}
+
+int Server::Listen() {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (listen_fd_ >= 0 || path_.size() >= sizeof(addr.sun_path)) return 1;
+  std::memcpy(addr.sun_path, path_.c_str(), path_.size());
+  if (pipe(wake_) != 0) return 1;
+  SetNonBlocking(wake_[0]);
+  SetNonBlocking(wake_[1]);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return 1;
+  unlink(path_.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    close(fd);
+    return 1;
+  }
+  SetNonBlocking(fd);
+  listen_fd_ = fd;
+  return 0;
+}
+
+void Server::Stop() {
+  char c = 0;
+  if (wake_[1] >= 0 && write(wake_[1], &c, 1) < 0) return;
+}
+
+int Server::Run() {
+  if (listen_fd_ < 0) return 1;
+  std::vector<pollfd> fds;
+  for (;;) {
+    fds = {{wake_[0], POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+    for (const auto& conn : conns_)
+      fds.push_back(
+          {conn.fd, short(conn.out.empty() ? POLLIN : POLLIN | POLLOUT), 0});
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      return 1;
+    }
+    if (fds[0].revents) break;
+    if (fds[1].revents & POLLIN) Accept();
+    // gather the complete requests of all clients into one batch
+    std::vector<Job> jobs;
+    std::vector<bool> alive(conns_.size(), true);
+    for (size_t i = 0; i < conns_.size() && i + 2 < fds.size(); i++) {
+      auto& conn = conns_[i];
+      auto revents = fds[i + 2].revents;
+      if (revents & (POLLIN | POLLHUP | POLLERR)) alive[i] = Read(conn);
+      size_t pos = 0, used = 0;
+      Request req;
+      for (FrameStatus st;
+           (st = Decode(conn.in.data() + pos, conn.in.size() - pos, used,
+                        req)) != FRAME_INCOMPLETE;
+           pos += used) {
+        if (st == FRAME_BAD) {  // cannot resynchronize with the stream
+          conn.closing = true;
+          pos = conn.in.size();
+          break;
+        }
+        jobs.push_back({i, std::move(req), {}});
+      }
+      conn.in.erase(0, pos);
+    }
+    Serve(jobs);
+    for (auto& job : jobs) Encode(job.response, conns_[job.conn].out);
+    // flush & drop the closed clients
+    for (size_t i = 0; i < conns_.size(); i++) {
+      if (alive[i] && !conns_[i].out.empty()) alive[i] = Write(conns_[i]);
+      if (conns_[i].closing && conns_[i].out.empty()) alive[i] = false;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < conns_.size(); i++) {
+      if (alive[i])
+        conns_[kept++] = std::move(conns_[i]);
+      else
+        close(conns_[i].fd);
+    }
+    conns_.resize(kept);
+  }
+  char buf[64];
+  while (read(wake_[0], buf, sizeof(buf)) > 0) {
+  }
+  return 0;
+}
+
+void Server::Accept() {
+  for (int fd; (fd = accept(listen_fd_, nullptr, nullptr)) >= 0;) {
+    SetNonBlocking(fd);
+    conns_.push_back({fd, {}, {}, false});
+  }
+}
+
+bool Server::Read(Conn& conn) {
+  char buf[kReadChunk];
+  for (;;) {
+    auto n = read(conn.fd, buf, sizeof(buf));
+    if (n > 0) {
+      conn.in.append(buf, n);
+    } else if (n == 0) {  // the client shut down its side
+      conn.closing = true;
+      return true;
+    } else {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+  }
+}
+
+bool Server::Write(Conn& conn) {
+  size_t pos = 0;
+  while (pos < conn.out.size()) {
+    auto n = send(conn.fd, conn.out.data() + pos, conn.out.size() - pos,
+                  MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+      break;
+    }
+    pos += n;
+  }
+  conn.out.erase(0, pos);
+  return true;
+}
+
+void Server::Serve(std::vector<Job>& jobs) {
+  if (jobs.empty()) return;
+  batches_++;
+  requests_ += jobs.size();
+  for (auto& job : jobs) job.response.seq = job.request.seq;
+  // creating or dropping a plane splits the batch, the parts between are
+  // grouped by plane
+  for (size_t begin = 0; begin < jobs.size();) {
+    size_t end = begin;
+    std::map<std::string, std::vector<Job*>> by_plane;
+    for (; end < jobs.size(); end++) {
+      const auto& req = jobs[end].request;
+      if (req.op == Request::CREATE || req.op == Request::DROP) break;
+      by_plane[req.plane].push_back(&jobs[end]);
+    }
+    std::vector<std::pair<Stitch*, std::vector<Job*>*>> groups;
+    for (auto& [name, group] : by_plane) {
+      auto it = planes_.find(name);
+      if (it != planes_.end()) {
+        groups.push_back({&it->second, &group});
+      } else {
+        for (auto* job : group) job->response.status = 1;
+      }
+    }
+    size_t per_plane = std::max<size_t>(1, threads_ / std::max<size_t>(
+                                                          1, groups.size()));
+    ParallelFor(groups.size(), std::min(threads_, groups.size()),
+                [&](size_t b, size_t e, size_t) {
+                  for (size_t i = b; i < e; i++)
+                    ServePlane(*groups[i].first, *groups[i].second,
+                               per_plane);
+                });
+    if (end == jobs.size()) break;
+    auto& job = jobs[end];
+    const auto& req = job.request;
+    if (req.op == Request::CREATE) {
+      bool ok = planes_.count(req.plane) == 0;
+      if (ok) planes_.emplace(req.plane, Stitch(req.area.coord, req.area.size));
+      job.response.status = !ok;
+    } else {
+      job.response.status = planes_.erase(req.plane) == 0;
+    }
+    begin = end + 1;
+  }
+}
+
+void Server::ServePlane(Stitch& s, const std::vector<Job*>& jobs,
+                        size_t threads) {
+  for (size_t begin = 0; begin < jobs.size();) {
+    size_t end = begin;
+    while (end < jobs.size() && jobs[end]->request.IsRead()) end++;
+    if (end == begin) {
+      Apply(s, jobs[begin]->request, jobs[begin]->response);
+      begin++;
+      continue;
+    }
+    // the run of reads [begin, end) sees the same plane
+    size_t n = end - begin;
+    ParallelFor(n, n < kMinParallelReads ? 1 : threads,
+                [&](size_t b, size_t e, size_t) {
+                  for (size_t i = begin + b; i < begin + e; i++)
+                    ApplyRead(s, jobs[i]->request, jobs[i]->response);
+                });
+    begin = end;
+  }
+}
+
+void Server::Apply(Stitch& s, const Request& req, Response& res) {
+  if (req.op == Request::INSERT) {
+    Id id = s.Insert(Tile(req.area.coord, req.area.size, false));
+    res.status = id == kNullId;
+    AddTile(s, id, res);
+  } else if (req.op == Request::DELETE) {
+    auto t = s.Delete(req.id);
+    res.status = !t;
+    if (t) {
+      res.ids.push_back(req.id);
+      res.tiles.push_back(Tile(t->coord, t->size, t->is_space));
+    }
+  } else {
+    ApplyRead(s, req, res);
+  }
+}
+
+void Server::ApplyRead(const Stitch& s, const Request& req, Response& res) {
+  const auto plane = s.Plane();
+  switch (req.op) {
+    case Request::TILE:
+      res.status = !s.Exist(req.id);
+      AddTile(s, req.id, res);
+      break;
+    case Request::POINT_FIND:
+      res.status = !plane.Contain(req.pt);
+      if (!res.status) AddTile(s, s.PointFinding(req.pt), res);
+      break;
+    case Request::AREA_SEARCH:
+      if (auto area = Clip(req.area, plane)) AddTile(s, s.AreaSearch(*area), res);
+      break;
+    case Request::AREA_ENUM:
+      if (auto area = Clip(req.area, plane))
+        for (Id id : s.AreaTiles(*area)) AddTile(s, id, res);
+      break;
+    default:
+      res.status = 1;
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+#include "stitch.hpp"
+
+// Serves named planes to local clients over a Unix domain socket.
+// The event loop reads every pipelined request available from all clients,
+// then serves them as one batch: the batch is grouped by plane, planes are
+// served in parallel, and inside a plane the runs of consecutive reads are
+// split over the threads while mutations are applied one at a time in
+// arrival order. Each client gets its responses in the order of its
+// requests.
+class Server {
+ public:
+  Server() = delete;
+  Server(const Server&) = delete;
+  // serve at the socket `path` with `threads` threads (0: all hardware)
+  explicit Server(const std::string& path, size_t threads = 0);
+  ~Server();
+
+  // bind & listen at the socket path, replacing a stale socket file,
+  // return 1 if failed
+  int Listen();
+  // serve until `Stop`, return 1 if not listening
+  int Run();
+  // make `Run` return, async-signal-safe
+  void Stop();
+  /* number of batches & requests served */
+  size_t NumBatches() const { return batches_; }
+  size_t NumRequests() const { return requests_; }
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  // a connected client
+  struct Conn {
+    int fd{-1};
+    std::string in, out;  // pending bytes
+    bool closing{false};  // close once `out` is flushed
+  };
+  // a request of the batch, answered into `response`
+  struct Job {
+    size_t conn;
+    Request request;
+    Response response;
+  };
+  const std::string path_;
+  const size_t threads_;
+  int listen_fd_{-1};
+  int wake_[2]{-1, -1};  // self-pipe woken by `Stop`
+  std::vector<Conn> conns_;
+  std::map<std::string, Stitch> planes_;
+  std::atomic<size_t> batches_{0}, requests_{0};
+
+  // accept pending connections
+  void Accept();
+  // read from & write to `conn`, return false if it is gone
+  bool Read(Conn& conn);
+  bool Write(Conn& conn);
+  // serve the batch `jobs`
+  void Serve(std::vector<Job>& jobs);
+  // serve the jobs of one plane in arrival order
+  void ServePlane(Stitch& s, const std::vector<Job*>& jobs, size_t threads);
+  // apply a request which does not create or drop a plane
+  static void Apply(Stitch& s, const Request& req, Response& res);
+  static void ApplyRead(const Stitch& s, const Request& req, Response& res);
+};
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <cmath>
+
+#include "stitch.hpp"
+
+/* floor(log2(`v`)) for a positive `v` */
+static int Log2(Len v) { return std::ilogb(v); }
+
+PlaneStats Stitch::Stats(Len sliver, size_t samples) const {
+  PlaneStats st;
+  for (size_t i = 0; i < tiles_.Size(); i++) {
+    if (!tiles_.Has(i)) continue;
+    const auto* t = &tiles_[i];
+    (t->is_space ? st.space : st.solid)++;
+    Len lo = std::min(t->size.x, t->size.y),
+        hi = std::max(t->size.x, t->size.y);
+    if (lo < sliver) st.slivers++;
+    if (lo > 0) {
+      st.area_histogram[Log2(lo * hi)]++;
+      st.aspect_histogram[Log2(hi / lo)]++;
+    }
+  }
+  // walk to the points of a n x n grid at the centers of its cells
+  size_t n = std::ceil(std::sqrt(Len(samples))), steps = 0;
+  if (NumTiles() && n) {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        PointFinding(
+            coord_ + Pt(size_.x / n * (j + 0.5), size_.y / n * (i + 0.5)),
+            kNullId, steps);
+    st.mean_walk = double(steps) / (n * n);
+  }
+  st.slots = tiles_.Size();
+  st.free_slots = tiles_.NumFree();
+  st.tiles_bytes = tiles_.ChunkBytes();
+  st.slots_bytes = tiles_.BookkeepingBytes();
+  st.wasted_bytes = st.tiles_bytes - NumTiles() * sizeof(TileStore::Slot);
+  return st;
+}
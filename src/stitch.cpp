@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
 Stitch::Stitch(const Pt& coord, const Pt& size) : coord_(coord), size_(size) {
@@ -13,7 +15,29 @@ Stitch::Stitch(const Pt& coord, const Pt& size) : coord_(coord), size_(size) {
   Ref(id).size = size;
 }
 
+thread_local std::vector<size_t>* Stitch::pool_ = nullptr;
+thread_local std::mutex* Stitch::pool_lock_ = nullptr;
+
+std::vector<Id> Stitch::Tiles() const {
+  std::vector<Id> ids;
+  ids.reserve(NumTiles());
+  for (size_t i = 0; i < tiles_.Size(); i++)
+    if (tiles_.Has(i)) ids.push_back(i);
+  return ids;
+}
+
+void Stitch::EnableSummary(int depth) {
+  summary_.emplace(Tile(coord_, size_), depth);
+  for (size_t i = 0; i < tiles_.Size(); i++)
+    if (tiles_.Has(i) && !tiles_[i].is_space) summary_->Add(tiles_[i]);
+}
+
 Id Stitch::PointFinding(const Pt& p, Id start) const {
+  size_t steps = 0;
+  return PointFinding(p, start, steps);
+}
+
+Id Stitch::PointFinding(const Pt& p, Id start, size_t& steps) const {
   Id id = Exist(start) ? start : LastInserted();
   Id prev_id = kNullId;
   while (id != kNullId && !Ref(id).Contain(p) && id != prev_id) {
@@ -28,6 +52,7 @@ Id Stitch::PointFinding(const Pt& p, Id start) const {
         break;
       else
         id = (cmp_y == Tile::LT) ? t.lb : t.rt;
+      steps++;
     }
     // move left/right using tr/bl, until the tile's horizontal range contains x
     while (id != kNullId) {
@@ -39,6 +64,7 @@ Id Stitch::PointFinding(const Pt& p, Id start) const {
         break;
       else
         id = (cmp_x == Tile::LT) ? t.bl : t.tr;
+      steps++;
     }
     // repeat since misalignment might occur
   }
@@ -46,80 +72,53 @@ Id Stitch::PointFinding(const Pt& p, Id start) const {
 }
 
 std::vector<Id> Stitch::RightNeighborFinding(Id id) const {
-  if (!Exist(id)) return {};
-  const auto& tl = Ref(id);
-  std::vector<Id> neighbors;
-  for (Id i = tl.tr;  // 1. go to tr
-       Exist(i);      //
-       i = Ref(i).lb  // 2. trace down through lb
-  ) {
-    if (Ref(i).IsRightNeighborTo(tl))
-      neighbors.push_back(i);
-    else
-      break;
-  }
-  return neighbors;
+  auto neighbors = RightNeighbors(id);
+  return std::vector<Id>(neighbors.begin(), neighbors.end());
 }
 
 std::vector<Id> Stitch::LeftNeighborFinding(Id id) const {
-  if (!Exist(id)) return {};
-  const auto& tl = Ref(id);
-  std::vector<Id> neighbors;
-  for (Id i = tl.bl;  // 1. go to bl
-       Exist(i);      //
-       i = Ref(i).rt  // 2. trace up through rt
-  ) {
-    if (Ref(i).IsLeftNeighborTo(tl))
-      neighbors.push_back(i);
-    else
-      break;
-  }
-  return neighbors;
+  auto neighbors = LeftNeighbors(id);
+  return std::vector<Id>(neighbors.begin(), neighbors.end());
 }
 
 std::vector<Id> Stitch::TopNeighborFinding(Id id) const {
-  if (!Exist(id)) return {};
-  const auto& tl = Ref(id);
-  std::vector<Id> neighbors;
-  for (Id i = tl.rt;  // 1. go to rt
-       Exist(i);      //
-       i = Ref(i).bl  // 2. trace left through bl
-  ) {
-    if (Ref(i).IsTopNeighborTo(tl))
-      neighbors.push_back(i);
-    else
-      break;
-  }
-  return neighbors;
+  auto neighbors = TopNeighbors(id);
+  return std::vector<Id>(neighbors.begin(), neighbors.end());
 }
 
 std::vector<Id> Stitch::BottomNeighborFinding(Id id) const {
-  if (!Exist(id)) return {};
-  const auto& tl = Ref(id);
-  std::vector<Id> neighbors;
-  for (Id i = tl.lb;  // 1. go to lb
-       Exist(i);      //
-       i = Ref(i).tr  // 2. trace right through tr
-  ) {
-    if (Ref(i).IsBottomNeighborTo(tl))
-      neighbors.push_back(i);
-    else
-      break;
-  }
-  return neighbors;
+  auto neighbors = BottomNeighbors(id);
+  return std::vector<Id>(neighbors.begin(), neighbors.end());
 }
 
 Id Stitch::AreaSearch(const Tile& area, Id start) const {
   if (!area.coord.InQuadrantI() || !area.size.IsSize() ||
       !Tile(coord_, size_).Contain(area))
     return kNullId;
+  if (summary_ && !summary_->MayOverlap(area)) return kNullId;
+  Id last = kNullId;
+  return AreaWalk(area, UpperLeftFinding(area, start), last);
+}
+
+Id Stitch::UpperLeftFinding(const Tile& area, Id start) const {
+  if (area.size.x > 0 && area.size.y > 0) {
+    // the tile containing the point just below the upper-left corner is the
+    // one overlapping the area, no walk along the bottom neighbors needed
+    Pt p(area.coord.x, std::nextafter(area.UpperLeftCorner().y, -kLenMax));
+    if (area.CmpY(p) == Tile::EQ) return PointFinding(p, start);
+  }
   // Point-finding the tile containing upper-left corner of the area
   Id id = PointFinding(area.UpperLeftCorner(), start);
   if (!area.Overlap(Ref(id))) {  // look for bottom neighbors
     for (id = Ref(id).lb; Exist(id); id = Ref(id).tr)
       if (area.Overlap(Ref(id))) break;
   }
+  return id;
+}
+
+Id Stitch::AreaWalk(const Tile& area, Id id, Id& last) const {
   while (Exist(id) && Ref(id).is_space) {  // If it is solid tile then return
+    last = id;
     // else not solid, check if its right edge overlaps the area
     if (area.OverlapVerticalLine(Ref(id).LowerRightCorner(), Ref(id).size.y)) {
       // then there must be solid tiles in the left neighbors
@@ -136,74 +135,152 @@ Id Stitch::AreaSearch(const Tile& area, Id start) const {
 }
 
 std::vector<Id> Stitch::AreaEnum(const Tile& area, Id start) const {
+  auto tiles = AreaTiles(area, start);
+  return std::vector<Id>(tiles.begin(), tiles.end());
+}
+
+Stitch::AreaIter::AreaIter(const Stitch* s, const Tile& area, Id start)
+    : s_(s), area_(area) {
   if (!area.coord.InQuadrantI() || !area.size.IsSize() ||
-      !Tile(coord_, size_).Contain(area))
-    return {};
-  std::vector<Id> enums;
+      !Tile(s_->coord_, s_->size_).Contain(area))
+    return;
   // Point-finding the tile containing upper-left corner of the area
-  Id id = PointFinding(area.UpperLeftCorner(), start);
-  if (!area.Overlap(Ref(id))) {  // look for bottom neighbors
-    for (id = Ref(id).lb; Exist(id); id = Ref(id).tr)
-      if (area.Overlap(Ref(id))) break;
+  Id id = s_->PointFinding(area.UpperLeftCorner(), start);
+  if (!area.Overlap(s_->Ref(id))) {  // look for bottom neighbors
+    for (id = s_->Ref(id).lb; s_->Exist(id); id = s_->Ref(id).tr)
+      if (area.Overlap(s_->Ref(id))) break;
   }
   // Step down through all the tiles along the left edge, as in AreaSearch
-  while (Exist(id) &&
-         Ref(id).OverlapVerticalLine(area.LowerLeftCorner(), area.size.y)) {
-    AreaEnumHelper(area, enums, id);  // calling helper (R procedure)
-    // move down to the next tile overlapping the area
-    for (id = Ref(id).lb; Exist(id); id = Ref(id).tr) {
-      if (Ref(id).OverlapVerticalLine(area.LowerLeftCorner(), area.size.y))
-        break;
+  if (s_->Exist(id) && s_->Ref(id).OverlapVerticalLine(
+                           area.LowerLeftCorner(), area.size.y)) {
+    left_ = id;
+    Push(id);
+  }
+}
+
+void Stitch::AreaIter::Push(Id id) {
+  // 1. Enumerate the tile
+  // 2. If the right edge of the tile is outside of the search area, skip its
+  // right neighbors
+  const auto& t = s_->Ref(id);
+  bool right = area_.OverlapVerticalLine(t.LowerRightCorner(), t.size.y);
+  stack_.push_back({id, right ? *NeighborIter(s_, id, NeighborIter::RIGHT)
+                              : kNullId});
+}
+
+Stitch::AreaIter& Stitch::AreaIter::operator++() {
+  while (stack_.size()) {
+    auto& f = stack_.back();
+    // 3. Otherwise, walk the tiles that touch the right side of the current
+    // tile and also intersect the searching area.
+    while (f.next != kNullId) {
+      Id i = f.next;
+      const auto &t = s_->Ref(f.id), &n = s_->Ref(i);
+      f.next = s_->Exist(n.lb) && s_->Ref(n.lb).IsRightNeighborTo(t)
+                   ? n.lb
+                   : kNullId;
+      if (!area_.Overlap(n)) continue;
+      // 4. For each of these neighbors, if the bottom left corner of the
+      // neighbor touches the current tile then enumerate the neighbor
+      // recursively.
+      const auto& llc = n.LowerLeftCorner();
+      bool corner =
+          t.LowerRightCorner().x == llc.x && t.CmpY(llc.y) == Tile::EQ;
+      // 5. Or, if the bottom edge of the search area cuts both the current
+      // tile and the neighbor, then enumerate the neighbor recursively.
+      bool cut =
+          t.OverlapHorizontalLine(area_.LowerLeftCorner(), area_.size.x) &&
+          n.OverlapHorizontalLine(area_.LowerLeftCorner(), area_.size.x);
+      if (corner || cut) {
+        Push(i);
+        return *this;
+      }
     }
+    stack_.pop_back();
+  }
+  // move down to the next tile overlapping the area along the left edge
+  Id id = s_->Exist(left_) ? s_->Ref(left_).lb : kNullId;
+  for (; s_->Exist(id); id = s_->Ref(id).tr)
+    if (s_->Ref(id).OverlapVerticalLine(area_.LowerLeftCorner(), area_.size.y))
+      break;
+  left_ = kNullId;
+  if (s_->Exist(id) && s_->Ref(id).OverlapVerticalLine(area_.LowerLeftCorner(),
+                                                       area_.size.y)) {
+    left_ = id;
+    Push(id);
   }
-  return enums;
+  return *this;
 }
 
-Id Stitch::Insert(Tile tile) {
-  if (!Tile(coord_, size_).Contain(tile)) return kNullId;
-  // if there's solid tiles in the inserted tile, abort
-  if (AreaSearch(tile) != kNullId) return kNullId;
+Id Stitch::Insert(Tile tile, Id start) {
+  // a tile without area (or NaN sizes) has no corner tiles to split
+  if (!(tile.size.x > 0 && tile.size.y > 0) ||
+      !Tile(coord_, size_).Contain(tile))
+    return kNullId;
+  if (track_) touched_.clear();
   // 1. Find the space tile containing the top edge of the new tile
-  Id top = PointFinding(tile.UpperLeftCorner());
-  if (!tile.Overlap(Ref(top)))  // look for bottom neighbors
-    for (top = Ref(top).lb; Exist(top); top = Ref(top).tr)
-      if (tile.Overlap(Ref(top))) break;
-  // 2. split the top tile
+  Id top = UpperLeftFinding(tile, start);
+  // if there's solid tiles in the inserted tile, abort; the walk down the
+  // left edge ends at the tile containing the bottom edge
+  Id bottom = kNullId;
+  if (summary_ && !summary_->MayOverlap(tile))
+    bottom = PointFinding(tile.LowerLeftCorner(), top);
+  else if (AreaWalk(tile, top, bottom) != kNullId)
+    return kNullId;
+  assert(Ref(bottom).Contain(tile.LowerLeftCorner()));
+  // 2. split the top tile, the lower part keeps its id
   HorizontalSplit(top, tile.UpperLeftCorner().y);
-  // 3. Find & split the space tile containing the bottom edge of the new tile
-  Id bottom = PointFinding(tile.LowerLeftCorner(), top);
+  // 3. split the space tile containing the bottom edge of the new tile
   Id new_bottom = HorizontalSplit(bottom, tile.LowerLeftCorner().y);
-  if (new_bottom != kNullId) bottom = new_bottom;
+  if (new_bottom != kNullId) {
+    if (top == bottom) top = new_bottom;  // the upper part contains the top
+    bottom = new_bottom;
+  }
   // 4. wall down along left side as AreaSearch
   Id last_id = kNullId, left = kNullId, right = kNullId;
   for (Id id = top; Exist(id) && tile.Overlap(Ref(id));) {
     // split left
     left = VerticalSplit(id, tile.LowerLeftCorner().x);
-    if (left != kNullId) std::swap(left, id);
-    HorizontalMerge(left, Ref(left).rt);
+    if (left != kNullId) {
+      std::swap(left, id);
+      HorizontalMerge(left, Ref(left).rt);
+    }
     // split right
     right = VerticalSplit(id, tile.LowerRightCorner().x);
-    HorizontalMerge(right, Ref(right).rt);
+    if (right != kNullId) HorizontalMerge(right, Ref(right).rt);
     // merge middle
     HorizontalMerge(id, last_id);
     last_id = id;
     // move down
     for (id = Ref(id).lb; Exist(id); id = Ref(id).tr) {
       if (tile.Overlap(Ref(id))) break;
-      if (tile.CmpX(Ref(id).coord.x) == Tile::GT) id = kNullId;
+      if (tile.CmpX(Ref(id).coord.x) == Tile::GT) {
+        id = kNullId;
+        break;
+      }
     }
   }
-  HorizontalMerge(Ref(left).lb, left);
-  HorizontalMerge(Ref(right).lb, right);
+  if (left != kNullId) HorizontalMerge(Ref(left).lb, left);
+  if (right != kNullId) HorizontalMerge(Ref(right).lb, right);
   Ref(last_id).is_space = false;
+  tiles_.Bump(last_id);
+  Touch(last_id);
+  if (summary_) summary_->Add(Ref(last_id));
+  // the next insert likely lands nearby, unless running in a band of
+  // ConcurrentStitch which passes its own start
+  if (!pool_) last_inserted_ = last_id;
   return last_id;
 }
 
 std::optional<Tile> Stitch::Delete(Id dead) {
   if (!Exist(dead) || Ref(dead).is_space) return std::nullopt;
+  if (track_) touched_.clear();
   auto ret = Ref(dead);
+  if (summary_) summary_->Remove(ret);
   // change the type of the dead tile to space.
   Ref(dead).is_space = true;
+  tiles_.Bump(dead);
+  Touch(dead);
   auto top = Ref(dead).UpperRightCorner().y;
   auto bottom = Ref(dead).LowerLeftCorner().y;
   // collect all right & left neighbors
@@ -224,22 +301,30 @@ std::optional<Tile> Stitch::Delete(Id dead) {
       VerticalMerge(dead_upper, r);  // solid r must filed
       split_dead.push_back(dead_upper);
     } else if (cut < bottom) {                 // neighbor need to be cut
-      auto r_upper = HorizontalSplit(r, cut);  // solid r must filed
-      VerticalMerge(dead, r_upper);            // solid r must filed
+      if (Ref(r).is_space)  // solid r must not be split
+        VerticalMerge(dead, HorizontalSplit(r, bottom));
       split_dead.push_back(dead);
     } else {                   // no need to cut
       VerticalMerge(dead, r);  // solid r must filed
       split_dead.push_back(dead);
     }
   }
+  // at the right boundary of the plane, the dead tile is left as a whole
+  if (right_neighbors.empty()) split_dead.push_back(dead);
   // split & merge left neighbors
   std::vector<Id> merge_dead;
-  for (auto l = left_neighbors.front();
+  for (auto l = left_neighbors.empty() ? kNullId : left_neighbors.front();
        Exist(l) && Ref(l).IsLeftNeighborTo(ret) && split_dead.size();) {
     if (Ref(l).is_space) {
       auto l_rt = Ref(l).rt;
       auto d = split_dead.back();
       split_dead.pop_back();
+      if (Ref(l).LowerRightCorner().y < Ref(d).LowerLeftCorner().y) {
+        // cut the lower part of l which does not touch d
+        // this should only happens when visiting the first neighbor
+        l = HorizontalSplit(l, Ref(d).LowerLeftCorner().y);
+        l_rt = Ref(l).rt;
+      }
       if (Ref(l).LowerRightCorner().y > Ref(d).LowerLeftCorner().y) {
         // cut the lower part of d which does not touch l
         // this should only happens when visiting the first neighbor
@@ -276,12 +361,15 @@ std::optional<Tile> Stitch::Delete(Id dead) {
       l = Ref(l).rt;
     }
   }
+  // pieces not reached by the left neighbors (the left boundary)
+  merge_dead.insert(merge_dead.end(), split_dead.rbegin(), split_dead.rend());
   // merge space tiles if possible
   for (auto d : merge_dead) {
-    if (Exist(d)) {
-      HorizontalMerge(d, Ref(d).rt);
-      HorizontalMerge(Ref(d).lb, d);
-    }
+    if (!Exist(d)) continue;
+    // merged pieces may in turn match the next tile above or below
+    while (HorizontalMerge(d, Ref(d).rt) != kNullId) continue;
+    for (Id lower; (lower = HorizontalMerge(Ref(d).lb, d)) != kNullId;)
+      d = lower;
   }
   return std::optional<Tile>{ret};
 }
@@ -290,60 +378,47 @@ Id Stitch::LastInserted() const {
   if (Exist(last_inserted_))
     return last_inserted_;
   else if (NumTiles() > 0)
-    for (int i = tiles_.size() - 1; i >= 0; i--)
-      if (tiles_[i].has_value()) return i;
+    for (int i = tiles_.Size() - 1; i >= 0; i--)
+      if (tiles_.Has(i)) return i;
   return kNullId;
 }
 
-void Stitch::AreaEnumHelper(const Tile& area, std::vector<Id>& enums,
-                            Id id) const {
-  // 1. Enumerate the tile
-  enums.push_back(id);
-  // 2. If the right edge of the tile is outside of the search area, return
-  if (!area.OverlapVerticalLine(Ref(id).LowerRightCorner(), Ref(id).size.y))
-    return;
-  // 3. Otherwise, use the neighbor-finding algorithm to locate all the tiles
-  // that touch the right side of the current tile and also intersect the
-  // searching area.
-  for (const auto& i : RightNeighborFinding(id)) {
-    if (area.Overlap(Ref(i))) {
-      // 4. For each of these neighbors, if the bottom left corner of the
-      // neighbor touches the current tile then call R to enumerate the
-      // neighbor recursively.
-      const auto& llc = Ref(i).LowerLeftCorner();
-      if (Ref(id).LowerRightCorner().x == llc.x &&
-          Ref(id).CmpY(llc.y) == Tile::EQ) {
-        AreaEnumHelper(area, enums, i);
-      }
-      // 5. Or, if the bottom edge of the search area cuts both the current
-      // tile and the neighbor, then call R to enumerate the neighbor
-      // recursively.
-      else if (  //
-          Ref(id).OverlapHorizontalLine(area.LowerLeftCorner(), area.size.x) &&
-          Ref(i).OverlapHorizontalLine(area.LowerLeftCorner(), area.size.x)) {
-        AreaEnumHelper(area, enums, i);
-      }
-    }
-  }
+Id Stitch::RightAlong(Id id, Len y) const {
+  // go to tr, then trace down through lb until the tile contains y
+  Id i = Ref(id).tr;
+  while (Exist(i) && Ref(i).CmpY(y) == Tile::LT) i = Ref(i).lb;
+  return (Exist(i) && Ref(i).CmpY(y) == Tile::EQ) ? i : kNullId;
 }
 
 Id Stitch::AllocTile() {
   Id id = kNullId;
-  if (slots_.size()) {
-    id = slots_.top();
-    slots_.pop();
-    tiles_[id] = Tile();
+  if (pool_) {
+    if (pool_->empty()) {
+      // too few slots reserved: take a free one, but never append one as
+      // the storage may be read by other threads meanwhile
+      std::lock_guard<std::mutex> lock(*pool_lock_);
+      if (!tiles_.NumFree()) {
+        std::cerr << "Stitch: no free tile slot left for a mutation\n";
+        std::abort();
+      }
+      pool_->push_back(tiles_.Take());
+    }
+    id = pool_->back();
+    pool_->pop_back();
   } else {
-    id = tiles_.size();
-    tiles_.push_back(Tile());
+    id = tiles_.Take();
   }
+  tiles_.Emplace(id);
   return id;
 }
 
 int Stitch::FreeTile(Id id) {
-  if (id != kNullId && 0 <= id && (size_t)id < tiles_.size()) {
-    tiles_[id] = std::nullopt;
-    slots_.push(id);
+  if (Exist(id)) {
+    tiles_.Erase(id);
+    if (pool_)
+      pool_->push_back(id);
+    else
+      tiles_.Give(id);
     return 0;
   } else {
     return 1;
@@ -361,6 +436,10 @@ Id Stitch::VerticalSplit(Id left, Len x) {
   auto right_neighbors = RightNeighborFinding(left);
   auto bottom_neighbors = BottomNeighborFinding(left);
   auto top_neighbors = TopNeighborFinding(left);
+  Touch({left, right});
+  Touch(right_neighbors);
+  Touch(bottom_neighbors);
+  Touch(top_neighbors);
   // update coord & size of the original & new tiles
   auto orig_size_x = Ref(left).size.x;
   Ref(left).size.x = x - Ref(left).coord.x;
@@ -403,6 +482,10 @@ Id Stitch::HorizontalSplit(Id lower, Len y) {
   auto top_neighbors = TopNeighborFinding(lower);
   auto left_neighbors = LeftNeighborFinding(lower);
   auto right_neighbors = RightNeighborFinding(lower);
+  Touch({lower, upper});
+  Touch(top_neighbors);
+  Touch(left_neighbors);
+  Touch(right_neighbors);
   // update coord & size of original & new tiles
   auto orig_size_y = Ref(lower).size.y;
   Ref(lower).size.y = y - Ref(lower).coord.y;
@@ -442,16 +525,26 @@ Id Stitch::VerticalMerge(Id left, Id right) {
       Ref(left).size.y != Ref(right).size.y)  // must align
     return kNullId;
   if (Ref(left).coord.x > Ref(right).coord.x) std::swap(left, right);
+  Touch(left);
   // update stitches touching new (right)
   // 1. for right, if bl = new, change to orig
   for (auto id : RightNeighborFinding(right))
-    if (Ref(id).bl == right) Ref(id).bl = left;
+    if (Ref(id).bl == right) {
+      Ref(id).bl = left;
+      Touch(id);
+    }
   // 2. for lower, if rt = new, change to orig
   for (auto id : BottomNeighborFinding(right))
-    if (Ref(id).rt == right) Ref(id).rt = left;
+    if (Ref(id).rt == right) {
+      Ref(id).rt = left;
+      Touch(id);
+    }
   // 3. for top, if lb = new, change to orig
   for (auto id : TopNeighborFinding(right))
-    if (Ref(id).lb == right) Ref(id).lb = left;
+    if (Ref(id).lb == right) {
+      Ref(id).lb = left;
+      Touch(id);
+    }
   // adjust the stitch of original tile
   Ref(left).tr = Ref(right).tr;
   Ref(left).rt = Ref(right).rt;
@@ -470,16 +563,26 @@ Id Stitch::HorizontalMerge(Id lower, Id upper) {
       Ref(lower).size.x != Ref(upper).size.x)  // must align
     return kNullId;
   if (Ref(lower).coord.y > Ref(upper).coord.y) std::swap(lower, upper);
+  Touch(lower);
   // update stitches touching new (upper)
   // 1. for upper, if lb = new, change to orig
   for (auto id : TopNeighborFinding(upper))
-    if (Ref(id).lb == upper) Ref(id).lb = lower;
+    if (Ref(id).lb == upper) {
+      Ref(id).lb = lower;
+      Touch(id);
+    }
   // 2. for left, if tr = new, change to orig
   for (auto id : LeftNeighborFinding(upper))
-    if (Ref(id).tr == upper) Ref(id).tr = lower;
+    if (Ref(id).tr == upper) {
+      Ref(id).tr = lower;
+      Touch(id);
+    }
   // 3. for right, if bl = new, change to orig
   for (auto id : RightNeighborFinding(upper))
-    if (Ref(id).bl == upper) Ref(id).bl = lower;
+    if (Ref(id).bl == upper) {
+      Ref(id).bl = lower;
+      Touch(id);
+    }
   // adjust the stitch of original tile
   Ref(lower).tr = Ref(upper).tr;
   Ref(lower).rt = Ref(upper).rt;
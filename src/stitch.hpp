@@ -1,29 +1,195 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <optional>
-#include <stack>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "store.hpp"
+#include "summary.hpp"
 #include "tile.hpp"
 
+// a design-rule violation found by `SpacingCheck` or `WidthCheck`
+struct Violation {
+  enum Kind {
+    SPACING = 0,  // solid tiles `a` & `b` are too close
+    WIDTH,        // tile `a` is too narrow (`b` is `kNullId`)
+  };
+  Kind kind{SPACING};
+  Id a{kNullId}, b{kNullId};
+  Len value{0};  // measured spacing or width
+  bool operator==(const Violation& v) const {
+    return kind == v.kind && a == v.a && b == v.b && value == v.value;
+  }
+};
+
+// a tile id with the generation of its slot, outdated once the tile is
+// freed or turns between space & solid, even if the id is reused later
+struct Handle {
+  Id id{kNullId};
+  uint32_t gen{0};
+  bool operator==(const Handle& h) const { return id == h.id && gen == h.gen; }
+  bool operator!=(const Handle& h) const { return !operator==(h); }
+};
+
+// a row-major 2-D array of values, row 0 lies at the bottom
+struct Grid {
+  size_t rows{0}, cols{0};
+  std::vector<Len> values;
+  Len At(size_t r, size_t c) const { return values[r * cols + c]; }
+};
+
+// shape & storage statistics of a plane reported by `Stitch::Stats`
+struct PlaneStats {
+  size_t solid{0}, space{0};  // number of tiles
+  size_t slivers{0};          // tiles narrower than the sliver threshold
+  // tiles by floor(log2(area)) & by floor(log2(long side / short side))
+  std::map<int, size_t> area_histogram, aspect_histogram;
+  double mean_walk{0};   // tiles stepped through by a sample PointFinding
+  size_t slots{0};       // size of the tile storage
+  size_t free_slots{0};  // deleted tiles waiting for reuse
+  size_t tiles_bytes{0};   // memory held by the allocated storage chunks
+  size_t slots_bytes{0};   // memory held by the storage bookkeeping
+  size_t wasted_bytes{0};  // allocated storage not holding a tile
+};
+
 class Stitch {
  public:
+  enum BoolOp {
+    AND = 0,
+    OR,
+    NOT,  // `a` AND NOT `b`
+    XOR,
+  };
+  enum Axis {
+    X = 0,
+    Y,
+  };
+  enum Dir {
+    EAST = 0,  // +x
+    NORTH,     // +y
+    WEST,      // -x
+    SOUTH,     // -y
+  };
+
+  // a pair of iterators usable in range-for & std algorithms
+  template <typename It>
+  struct Range {
+    It first, last;
+    It begin() const { return first; }
+    It end() const { return last; }
+  };
+
+  // Lazily walks the neighbors of a tile along one edge through the
+  // stitches, in the order of the corresponding *NeighborFinding.
+  // Invalidated by Insert/Delete.
+  class NeighborIter {
+   public:
+    enum Edge { RIGHT = 0, LEFT, TOP, BOTTOM };
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Id value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Id* pointer;
+    typedef const Id& reference;
+
+    NeighborIter() = default;  // the end
+    NeighborIter(const Stitch* s, Id id, Edge edge);
+    reference operator*() const { return cur_; }
+    pointer operator->() const { return &cur_; }
+    NeighborIter& operator++();
+    NeighborIter operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+    bool operator==(const NeighborIter& it) const { return cur_ == it.cur_; }
+    bool operator!=(const NeighborIter& it) const { return cur_ != it.cur_; }
+
+   private:
+    const Stitch* s_{nullptr};
+    Id id_{kNullId}, cur_{kNullId};
+    Edge edge_{RIGHT};
+    // end the walk unless `cur_` still touches the edge
+    void Check();
+  };
+  typedef Range<NeighborIter> NeighborRange;
+
+  // Lazily enumerates the tiles in an area in the order of AreaEnum, the
+  // recursion of AreaEnum is kept on an explicit stack.
+  // Invalidated by Insert/Delete.
+  class AreaIter {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Id value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Id* pointer;
+    typedef const Id& reference;
+
+    AreaIter() = default;  // the end
+    AreaIter(const Stitch* s, const Tile& area, Id start);
+    reference operator*() const { return stack_.back().id; }
+    pointer operator->() const { return &stack_.back().id; }
+    AreaIter& operator++();
+    AreaIter operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+    bool operator==(const AreaIter& it) const {
+      return stack_.empty() ? it.stack_.empty()
+                            : !it.stack_.empty() && **this == *it;
+    }
+    bool operator!=(const AreaIter& it) const { return !operator==(it); }
+
+   private:
+    struct Frame {
+      Id id;    // the enumerated tile
+      Id next;  // its next right neighbor to look at
+    };
+    const Stitch* s_{nullptr};
+    Tile area_;
+    Id left_{kNullId};  // the current tile along the left edge of the area
+    std::vector<Frame> stack_;
+    // enumerate tile `id`
+    void Push(Id id);
+  };
+  typedef Range<AreaIter> AreaRange;
+
   Stitch() = default;
   Stitch(const Stitch& stitch) = default;
   Stitch(const Pt& coord, const Pt& size);
 
-  bool Exist(Id id) const {
-    return id != kNullId && 0 <= id && (size_t)id < tiles_.size() &&
-           tiles_[id].has_value();
-  }
+  bool Exist(Id id) const { return 0 <= id && tiles_.Has(id); }
   /* get a copy of tile */
   std::optional<Tile> At(Id id) const {
-    return (id != kNullId && 0 <= id && (size_t)id < tiles_.size())
-               ? tiles_[id]
-               : std::nullopt;
+    return Exist(id) ? std::optional<Tile>(tiles_[id]) : std::nullopt;
+  }
+  /* tile `id` without copy, `nullptr` if missing, invalidated by Insert/Delete */
+  const Tile* Get(Id id) const { return Exist(id) ? &tiles_[id] : nullptr; }
+  /* handle of tile `id`, the default (null) handle if missing */
+  Handle GetHandle(Id id) const {
+    return Exist(id) ? Handle{id, tiles_.Gen(id)} : Handle();
   }
+  /* the tile of handle `h` is still there? a solid tile stays until deleted,
+   * a space tile may be reshaped meanwhile */
+  bool Valid(const Handle& h) const {
+    return Exist(h.id) && tiles_.Gen(h.id) == h.gen;
+  }
+  /* id of the tile of handle `h`, `kNullId` if outdated */
+  Id Resolve(const Handle& h) const { return Valid(h) ? h.id : kNullId; }
+  /* ids of all tiles lie in [0, NumSlots()) */
+  size_t NumSlots() const { return tiles_.Size(); }
+  /* the whole plane as a tile */
+  Tile Plane() const { return Tile(coord_, size_); }
   /* number of tiles */
-  size_t NumTiles() const { return tiles_.size() - slots_.size(); }
+  size_t NumTiles() const { return tiles_.Size() - tiles_.NumFree(); }
+  /* ids of all existing tiles */
+  std::vector<Id> Tiles() const;
   // find the tile at `pt`, default start at `last_inserted_`
   Id PointFinding(const Pt& pt, Id start = kNullId) const;
   // find all neighbors contacting the right edge of tile `id` (top to down)
@@ -34,35 +200,191 @@ class Stitch {
   std::vector<Id> TopNeighborFinding(Id id) const;
   // find all neighbors contacting the bottom edge of tile `id` (left to right)
   std::vector<Id> BottomNeighborFinding(Id id) const;
+  // lazy views of the *NeighborFinding & AreaEnum results
+  NeighborRange RightNeighbors(Id id) const {
+    return {NeighborIter(this, id, NeighborIter::RIGHT), NeighborIter()};
+  }
+  NeighborRange LeftNeighbors(Id id) const {
+    return {NeighborIter(this, id, NeighborIter::LEFT), NeighborIter()};
+  }
+  NeighborRange TopNeighbors(Id id) const {
+    return {NeighborIter(this, id, NeighborIter::TOP), NeighborIter()};
+  }
+  NeighborRange BottomNeighbors(Id id) const {
+    return {NeighborIter(this, id, NeighborIter::BOTTOM), NeighborIter()};
+  }
+  AreaRange AreaTiles(const Tile& area, Id start = kNullId) const {
+    return {AreaIter(this, area, start), AreaIter()};
+  }
+  // the tiles crossed by the segment of `length` from `p` toward `dir`,
+  // from the tile at `p` on, following the stitches along the segment;
+  // with `stop_at_solid` the walk ends at the first solid tile
+  std::vector<Id> SegmentWalk(const Pt& p, Len length, Dir dir,
+                              bool stop_at_solid = false,
+                              Id start = kNullId) const;
+  // the first solid tile hit by the ray from `p` toward `dir` (the tile at
+  // `p` included), `kNullId` if it leaves the plane first
+  Id RayShoot(const Pt& p, Dir dir, Id start = kNullId) const;
+  // the (up to) `k` solid tiles nearest to `p` by rectilinear distance, at
+  // most `max_dist` away, as (id, distance) pairs by distance then id;
+  // tiles are reached best-first through the neighbors from the tile at `p`
+  std::vector<std::pair<Id, Len>> NearestSolid(const Pt& p,
+                                               Len max_dist = kLenMax,
+                                               size_t k = 1,
+                                               Id start = kNullId) const;
   // find the left-most-top solid tile in the given area
   Id AreaSearch(const Tile& area, Id start = kNullId) const;
   // enumerate all tiles in the given area,
   // each tile is visited after all its upper & left tiles are visited
   std::vector<Id> AreaEnum(const Tile& area, Id start = kNullId) const;
-  // return the pointer of the inserted tile if success, else return `kNullId`
-  Id Insert(Tile tile);
+  // return the pointer of the inserted tile if success, else return `kNullId`,
+  // the tiles around `tile` are located starting at `start` if given
+  Id Insert(Tile tile, Id start = kNullId);
   // return the deleted tile if success, else return `std::nullopt`
   std::optional<Tile> Delete(Id id);
+  // enlarge the plane to `coord` & `size` in place by stretching the space
+  // tiles along its border or adding space tiles next to the solid ones,
+  // only the border tiles are touched; return 0 if success else return 1
+  // (the new plane must contain the old one)
+  int Extend(const Pt& coord, const Pt& size);
+  // find solid tile pairs closer than `spacing` (euclidean, touching excluded)
+  // by walking the space tiles around each solid tile, on `threads` threads
+  std::vector<Violation> SpacingCheck(Len spacing, size_t threads = 0) const;
+  // find solid tiles & space tiles enclosed by solid tiles along one axis
+  // which are narrower than `width`, on `threads` threads
+  std::vector<Violation> WidthCheck(Len width, size_t threads = 0) const;
+  // check the stitches, edge coverage & maximal strips of every tile, and
+  // that the stitches reach all tiles from the lower-left corner, return
+  // the invalid tiles (`kNullId` if some tile is not reached, e.g. tiles
+  // lying over others or no tile at the corner)
+  std::vector<Id> Validate() const;
+  // check as `Validate` only the tiles touched by the last Insert/Delete
+  // and their neighbors, requires `TrackTouched(true)`
+  std::vector<Id> ValidateTouched() const;
+  // start/stop recording the tiles touched by each Insert/Delete
+  void TrackTouched(bool enable) {
+    track_ = enable;
+    touched_.clear();
+  }
+  /* tiles touched by the last Insert/Delete, freed ones included */
+  const std::vector<Id>& Touched() const { return touched_; }
+  // keep a quadtree summary of depth `depth` of the solid tiles, letting
+  // AreaSearch (and so Insert) skip the walk over empty areas
+  void EnableSummary(int depth = 8);
+  void DisableSummary() { summary_.reset(); }
+  const std::optional<Summary>& GetSummary() const { return summary_; }
+  // solid area density of windows sized `window` stepped by `step` inside
+  // `area`, each tile in a row band is clipped once, on `threads` threads
+  Grid DensityMap(const Tile& area, const Pt& window, const Pt& step,
+                  size_t threads = 0) const;
+  // paint `rows` x `cols` pixels of size `pitch` from `origin` into the
+  // row-major `pixels` (row 0 at the bottom); a pixel is 1 (or id + 1 if
+  // `label`) if its center lies in a solid tile, else 0; rows are split
+  // into bands enumerated by `threads` threads (T: uint8_t, uint32_t);
+  // return 0 if success, else (an id + 1 may not fit into T with `label`)
+  // return 1 without painting
+  template <typename T>
+  int Rasterize(const Pt& origin, Len pitch, size_t rows, size_t cols,
+                T* pixels, bool label = false, size_t threads = 0) const;
+  // visit the solid region of `a` `op` `b` inside the plane of `a` as
+  // rectangles, strip by strip from top to bottom; the rows of tiles of
+  // both planes advance together, each tile is stepped over once
+  static void Boolean(const Stitch& a, const Stitch& b, BoolOp op,
+                      const std::function<void(const Tile&)>& visit);
+  // return a new plane (with the extent of `a`) of `a` `op` `b`, built from
+  // the result tiles at once instead of inserting them
+  static Stitch Boolean(const Stitch& a, const Stitch& b, BoolOp op);
+  // visit the solid region grown by `d` (shrunk by -`d` if negative) in
+  // every direction & clipped to the plane as disjoint rectangles, from one
+  // sweep over the grown solid (or space) tiles merging them strip by strip
+  void Bloat(Len d, const std::function<void(const Tile&)>& visit) const;
+  // return a new plane of the solid region grown / shrunk by `d`, outside
+  // of the plane counts as space
+  Stitch Bloat(Len d) const;
+  Stitch Shrink(Len d) const { return Bloat(-d); }
+  // report tile counts & shapes, slivers narrower than `sliver`, the mean
+  // walk of PointFinding over `samples` points of a grid on the plane (from
+  // the default start) & the storage use, in one pass over the tiles
+  PlaneStats Stats(Len sliver = 0, size_t samples = 64) const;
+  // label the solid tiles passing `filter` (all if unset) by connected
+  // component of edge-touching tiles: the result maps each id in
+  // [0, NumSlots()) to the smallest id of its component, or `kNullId`;
+  // chunks of tiles are unioned by `threads` threads into a lock-free
+  // union-find
+  std::vector<Id> ConnectedComponents(
+      const std::function<bool(const Tile&)>& filter = nullptr,
+      size_t threads = 0) const;
+  // drop the free tile slots at the end of the storage & return the
+  // storage chunks holding no tile to the allocator
+  void ShrinkToFit() { tiles_.ShrinkToFit(); }
+  // visit the solid tiles pushed toward the lower edge of the plane along
+  // `axis`, in an order each tile follows the tiles it is pushed against;
+  // tiles visible to each other along `axis` keep a gap of `spacing` (or
+  // their original gap if narrower), found by longest paths over the
+  // visibility graph read from the stitches
+  void Compact(Axis axis, Len spacing,
+               const std::function<void(Id, const Tile&)>& visit) const;
+  // return a new plane of the compacted solid tiles, built at once from
+  // them & the space strips swept around them (as is the transposed plane
+  // compacted for `Y`)
+  Stitch Compact(Axis axis, Len spacing) const;
+  // the whole state as bytes, including the order of the free slots so a
+  // deserialized plane assigns the same ids to later tiles
+  std::string Serialize() const;
+  // rebuild a plane from the bytes of `Serialize`, `std::nullopt` if malformed
+  static std::optional<Stitch> Deserialize(const std::string& data);
+  // rebuild the plane journaled into the directory `dir` by `Journal` from
+  // its last checkpoint & the complete records after it, `std::nullopt` if
+  // the checkpoint is missing or corrupted or a record fails to replay
+  static std::optional<Stitch> Recover(const std::string& dir);
 
 #ifdef GTEST
  public:
 #else
  protected:
 #endif
+  friend class ConcurrentStitch;
+
   /* default: cover QuadrantI*/
   Pt coord_{0, 0};             // lower-left corner
   Pt size_{kLenMax, kLenMax};  // (width, height)
-  std::vector<std::optional<Tile>> tiles_;
-  std::stack<size_t> slots_;   // index in tiles_ which are already deleted
+  TileStore tiles_;
   Id last_inserted_{kNullId};  // record last tile for better locality
+  bool track_{false};          // record touched tiles or not
+  std::vector<Id> touched_;    // tiles touched by the last Insert/Delete
+  std::optional<Summary> summary_;  // occupancy of solid tiles if enabled
+  // free slots reserved by the mutation running on this thread if set,
+  // used instead of the free list of `tiles_`, which is only taken from
+  // under `pool_lock_` once they run out (see ConcurrentStitch)
+  static thread_local std::vector<size_t>* pool_;
+  static thread_local std::mutex* pool_lock_;
 
   // get reference of tile `id` (without check)
-  const Tile& Ref(Id id) const { return tiles_[id].value(); }
-  Tile& Ref(Id id) { return tiles_[id].value(); }
+  const Tile& Ref(Id id) const { return tiles_[id]; }
+  Tile& Ref(Id id) { return tiles_[id]; }
 
+  // the first tile overlapping `area` along its left edge from the top
+  Id UpperLeftFinding(const Tile& area, Id start) const;
+  // walk down the left edge of `area` from tile `id` as AreaSearch, return
+  // the solid tile found or `kNullId`, the last space tile walked (the one
+  // at the lower-left corner if none is found) is kept in `last`
+  Id AreaWalk(const Tile& area, Id id, Id& last) const;
+  // `PointFinding` adding the number of steps to `steps`
+  Id PointFinding(const Pt& pt, Id start, size_t& steps) const;
   Id LastInserted() const;
-  // the recursive R procedure called by AreaEnum
-  void AreaEnumHelper(const Tile& area, std::vector<Id>& enums, Id id) const;
+  // record tiles modified by the current Insert/Delete
+  void Touch(Id id) {
+    if (track_) touched_.push_back(id);
+  }
+  void Touch(const std::vector<Id>& ids) {
+    if (track_) touched_.insert(touched_.end(), ids.begin(), ids.end());
+  }
+  // return 0 if tile `id` is valid locally else return 1
+  int ValidateTile(Id id) const;
+  // the tile after tile `id` along the horizontal line y=`y` to the right
+  Id RightAlong(Id id, Len y) const;
+  // the tile after tile `id` along the line through `p` toward `dir`
+  Id Along(Id id, const Pt& p, Dir dir) const;
   // allocate a new tile, return its id
   Id AllocTile();
   // free tile `id`, return 0 if success else return 1
@@ -75,4 +397,42 @@ class Stitch {
   Id VerticalMerge(Id left, Id right);
   // horizontally merge tiles `lower` & `upper`, return the merged tile
   Id HorizontalMerge(Id lower, Id upper);
+  // replace all tiles by `tiles`, which cover the plane exactly (space ones
+  // in maximal horizontal strips), stitching them by their sorted edges,
+  // return their ids in order
+  std::vector<Id> Build(const std::vector<Tile>& tiles);
 };
+
+inline Stitch::NeighborIter::NeighborIter(const Stitch* s, Id id, Edge edge)
+    : s_(s), id_(id), edge_(edge) {
+  if (!s_->Exist(id_)) return;
+  const auto& t = s_->Ref(id_);
+  cur_ = edge_ == RIGHT  ? t.tr  // then trace down through lb
+         : edge_ == LEFT ? t.bl  // then trace up through rt
+         : edge_ == TOP  ? t.rt  // then trace left through bl
+                         : t.lb;  // then trace right through tr
+  Check();
+}
+
+inline Stitch::NeighborIter& Stitch::NeighborIter::operator++() {
+  const auto& t = s_->Ref(cur_);
+  cur_ = edge_ == RIGHT  ? t.lb
+         : edge_ == LEFT ? t.rt
+         : edge_ == TOP  ? t.bl
+                         : t.tr;
+  Check();
+  return *this;
+}
+
+inline void Stitch::NeighborIter::Check() {
+  if (!s_->Exist(cur_)) {
+    cur_ = kNullId;
+    return;
+  }
+  const auto &t = s_->Ref(id_), &n = s_->Ref(cur_);
+  bool touch = edge_ == RIGHT  ? n.IsRightNeighborTo(t)
+               : edge_ == LEFT ? n.IsLeftNeighborTo(t)
+               : edge_ == TOP  ? n.IsTopNeighborTo(t)
+                               : n.IsBottomNeighborTo(t);
+  if (!touch) cur_ = kNullId;
+}
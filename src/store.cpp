@@ -0,0 +1,235 @@
+#include "store.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <new>
+
+static constexpr size_t kChunkBytes =
+    TileStore::kChunk * sizeof(TileStore::Slot);
+
+void TileStore::Unmap::operator()(Slot* chunk) const {
+  munmap(chunk, kChunkBytes);
+}
+
+TileStore::Chunk TileStore::NewChunk() {
+  // big enough for its own mapping, which munmap returns to the OS unlike
+  // a heap block
+  void* p = mmap(nullptr, kChunkBytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) throw std::bad_alloc();
+  auto chunk = static_cast<Slot*>(p);
+  std::uninitialized_default_construct_n(chunk, kChunk);
+  return Chunk(chunk);
+}
+
+TileStore::TileStore(const TileStore& store) { operator=(store); }
+
+TileStore& TileStore::operator=(const TileStore& store) {
+  if (this == &store) return *this;
+  chunks_.clear();
+  for (const auto& chunk : store.chunks_) {
+    chunks_.emplace_back(chunk ? NewChunk() : nullptr);
+    if (chunk)
+      std::copy(chunk.get(), chunk.get() + kChunk, chunks_.back().get());
+  }
+  live_ = store.live_;
+  released_ = store.released_;
+  size_ = store.size_;
+  num_free_ = store.num_free_;
+  head_ = store.head_;
+  gen_floor_ = store.gen_floor_;
+  spare_ = store.spare_;
+  return *this;
+}
+
+bool TileStore::operator==(const TileStore& store) const {
+  if (size_ != store.size_ || num_free_ != store.num_free_ ||
+      gen_floor_ != store.gen_floor_)
+    return false;
+  for (size_t i = 0; i < size_; i++) {
+    if (Has(i) != store.Has(i)) return false;
+    if (Has(i) && (*this)[i] != store[i]) return false;
+    size_t c = i >> kChunkBits;
+    if (!chunks_[c] != !store.chunks_[c] || Gen(i) != store.Gen(i))
+      return false;
+  }
+  return FreeList() == store.FreeList() && released_ == store.released_;
+}
+
+std::optional<TileStore> TileStore::Restore(
+    const std::vector<std::optional<Tile>>& tiles,
+    const std::vector<size_t>& free, const std::vector<size_t>& released,
+    const std::vector<uint32_t>& gens, uint32_t gen_floor) {
+  if (gens.size() && gens.size() != tiles.size()) return std::nullopt;
+  TileStore s;
+  s.gen_floor_ = gen_floor;
+  while (s.size_ < tiles.size()) {
+    size_t i = s.Append();
+    s.live_[i >> kChunkBits]++;
+    if (tiles[i]) s.At(i) = {*tiles[i], gen_floor, TILE};
+    if (gens.size()) s.At(i).gen = gens[i];
+  }
+  // list each empty slot once, as free or in a released chunk
+  std::vector<bool> listed(tiles.size(), false);
+  auto list = [&](size_t i) {
+    if (i >= tiles.size() || tiles[i] || listed[i]) return false;
+    listed[i] = true;
+    return true;
+  };
+  for (size_t c : released)
+    for (size_t i = c << kChunkBits; i < s.ChunkEnd(c); i++)
+      if (!list(i)) return std::nullopt;
+  for (size_t i : free)
+    if (!list(i)) return std::nullopt;
+  if (std::count(listed.begin(), listed.end(), true) !=
+      std::count(tiles.begin(), tiles.end(), std::nullopt))
+    return std::nullopt;
+  for (auto it = free.rbegin(); it != free.rend(); it++) {
+    s.Link(*it);
+    s.live_[*it >> kChunkBits]--;
+    s.num_free_++;
+  }
+  for (size_t c : released) {
+    s.chunks_[c].reset();
+    s.live_[c] = 0;
+    s.num_free_ += s.ChunkEnd(c) - (c << kChunkBits);
+  }
+  s.released_ = released;
+  return s;
+}
+
+size_t TileStore::NumChunks() const {
+  return std::count_if(chunks_.begin(), chunks_.end(),
+                       [](const auto& chunk) { return chunk != nullptr; });
+}
+
+size_t TileStore::BookkeepingBytes() const {
+  return chunks_.capacity() * sizeof(chunks_[0]) +
+         live_.capacity() * sizeof(live_[0]) +
+         released_.capacity() * sizeof(released_[0]);
+}
+
+void TileStore::Link(size_t i) {
+  auto& s = At(i);
+  s.state = FREE;
+  s.tile.bl = kNullId;
+  s.tile.tr = head_;
+  if (head_ != kNullId) At(head_).tile.bl = i;
+  head_ = i;
+}
+
+void TileStore::Unlink(size_t i) {
+  const auto& t = At(i).tile;
+  if (t.bl != kNullId)
+    At(t.bl).tile.tr = t.tr;
+  else
+    head_ = t.tr;
+  if (t.tr != kNullId) At(t.tr).tile.bl = t.bl;
+}
+
+size_t TileStore::Append() {
+  size_t i = size_++;
+  if ((i >> kChunkBits) == chunks_.size()) {
+    chunks_.emplace_back(NewChunk());
+    live_.push_back(0);
+  }
+  At(i).gen = gen_floor_;
+  return i;
+}
+
+void TileStore::Drop(size_t c, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++)
+    gen_floor_ = std::max(gen_floor_, chunks_[c][i].gen + 1);
+}
+
+size_t TileStore::Take() {
+  if (head_ == kNullId && released_.size()) {
+    Reuse(released_.back());
+    released_.pop_back();
+  }
+  size_t i;
+  if (head_ != kNullId) {
+    i = head_;
+    Unlink(i);
+    num_free_--;
+  } else {
+    i = Append();
+  }
+  At(i).state = TAKEN;
+  live_[i >> kChunkBits]++;
+  return i;
+}
+
+void TileStore::Give(size_t i) {
+  Link(i);
+  num_free_++;
+  size_t c = i >> kChunkBits;
+  if (--live_[c]) return;
+  // keeping one empty chunk, taking & giving back slots around a chunk
+  // boundary does not map & unmap it each time
+  if (spare_ < chunks_.size() && spare_ != c && chunks_[spare_] &&
+      live_[spare_] == 0)
+    Release(spare_);
+  spare_ = c;
+}
+
+void TileStore::Reserve(size_t n) {
+  // the new slots are handed out last appended first
+  while (num_free_ < n) {
+    // a released chunk at the end is reused before appending to it
+    if ((size_ & (kChunk - 1)) && !chunks_.back()) {
+      size_t c = chunks_.size() - 1;
+      released_.erase(std::find(released_.begin(), released_.end(), c));
+      Reuse(c);
+    }
+    Link(Append());
+    num_free_++;
+  }
+}
+
+void TileStore::Release(size_t c) {
+  for (size_t i = c << kChunkBits; i < ChunkEnd(c); i++) Unlink(i);
+  Drop(c, 0, ChunkEnd(c) - (c << kChunkBits));
+  chunks_[c].reset();
+  released_.push_back(c);
+}
+
+void TileStore::Reuse(size_t c) {
+  chunks_[c] = NewChunk();
+  for (size_t i = ChunkEnd(c); i-- > (c << kChunkBits);) {
+    Link(i);
+    At(i).gen = gen_floor_;
+  }
+}
+
+void TileStore::ShrinkToFit() {
+  while (size_) {
+    size_t c = (size_ - 1) >> kChunkBits;
+    if (!chunks_[c]) {  // all its slots are free
+      released_.erase(std::find(released_.begin(), released_.end(), c));
+      num_free_ -= size_ - (c << kChunkBits);
+      size_ = c << kChunkBits;
+    } else if (At(size_ - 1).state == FREE) {
+      Unlink(--size_);
+      num_free_--;
+      Drop(c, size_ & (kChunk - 1), (size_ & (kChunk - 1)) + 1);
+      if (size_ & (kChunk - 1)) continue;
+    } else {
+      break;
+    }
+    chunks_.pop_back();
+    live_.pop_back();
+  }
+  for (size_t c = 0; c < chunks_.size(); c++)
+    if (chunks_[c] && live_[c] == 0) Release(c);
+  chunks_.shrink_to_fit();
+  live_.shrink_to_fit();
+  released_.shrink_to_fit();
+}
+
+std::vector<size_t> TileStore::FreeList() const {
+  std::vector<size_t> ids;
+  for (Id i = head_; i != kNullId; i = At(i).tile.tr) ids.push_back(i);
+  return ids;
+}
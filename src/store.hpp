@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "tile.hpp"
+
+// The tile storage of a plane indexed by id, allocated in chunks of
+// `kChunk` slots mapped straight from the OS, so a released chunk is
+// returned to it. Free slots form a doubly-linked free list threaded
+// through their own stitches. The chunk left without tiles last is kept as
+// a spare; once another one empties (or on `ShrinkToFit`) an empty chunk
+// is unlinked from the free list & released, its slots are handed out
+// again (lowest first) once the free list is exhausted, the last released
+// chunk first.
+// Each slot counts a generation, bumped whenever its tile is freed (or on
+// `Bump`); slots leaving the store or released start over above every
+// generation seen, so an (id, generation) pair is never reused.
+class TileStore {
+ public:
+  static constexpr size_t kChunkBits = 10;
+  static constexpr size_t kChunk = size_t(1) << kChunkBits;
+  enum State : uint8_t {
+    FREE = 0,  // in the free list (or a released chunk)
+    TAKEN,     // handed out by `Take`, holding no tile
+    TILE,      // holding a tile
+  };
+  struct Slot {
+    Tile tile;
+    uint32_t gen{0};
+    State state{FREE};
+  };
+  // unmaps a chunk
+  struct Unmap {
+    void operator()(Slot* chunk) const;
+  };
+  typedef std::unique_ptr<Slot[], Unmap> Chunk;
+
+  TileStore() = default;
+  TileStore(const TileStore& store);
+  TileStore(TileStore&& store) = default;
+  TileStore& operator=(const TileStore& store);
+  TileStore& operator=(TileStore&& store) = default;
+  // the same tiles, handed out in the same order
+  bool operator==(const TileStore& store) const;
+  bool operator!=(const TileStore& store) const { return !operator==(store); }
+  // rebuild a store of `tiles` from `FreeList` & `Released` (& `Gen` of
+  // each slot & `GenFloor` if given), `std::nullopt` unless each empty slot
+  // is listed exactly once
+  static std::optional<TileStore> Restore(
+      const std::vector<std::optional<Tile>>& tiles,
+      const std::vector<size_t>& free, const std::vector<size_t>& released,
+      const std::vector<uint32_t>& gens = {}, uint32_t gen_floor = 0);
+
+  /* ids lie in [0, Size()) */
+  size_t Size() const { return size_; }
+  /* number of free slots, released ones included */
+  size_t NumFree() const { return num_free_; }
+  /* number of allocated chunks */
+  size_t NumChunks() const;
+  /* memory held, chunks & bookkeeping */
+  size_t ChunkBytes() const { return NumChunks() * kChunk * sizeof(Slot); }
+  size_t BookkeepingBytes() const;
+  /* slot `i` holds a tile? */
+  bool Has(size_t i) const {
+    return i < size_ && chunks_[i >> kChunkBits] && At(i).state == TILE;
+  }
+  // tile of slot `i` (without check)
+  Tile& operator[](size_t i) { return At(i).tile; }
+  const Tile& operator[](size_t i) const { return At(i).tile; }
+
+  // hand out a free slot holding no tile, appended if none
+  size_t Take();
+  // return slot `i` from `Take` to the free list, its chunk becomes the
+  // spare if it holds no tile anymore (releasing the previous spare)
+  void Give(size_t i);
+  // put a default tile into slot `i` from `Take` / remove it
+  void Emplace(size_t i) {
+    At(i).tile = Tile();
+    At(i).state = TILE;
+  }
+  void Erase(size_t i) {
+    At(i).state = TAKEN;
+    At(i).gen++;
+  }
+  /* generation of slot `i`, changed by `Erase` & `Bump` */
+  uint32_t Gen(size_t i) const {
+    return chunks_[i >> kChunkBits] ? At(i).gen : gen_floor_;
+  }
+  void Bump(size_t i) { At(i).gen++; }
+  /* generation given to the slots appended or reused */
+  uint32_t GenFloor() const { return gen_floor_; }
+  // append free slots until `n` are available
+  void Reserve(size_t n);
+  // drop the free slots at the end & release the chunks without tiles
+  void ShrinkToFit();
+  /* the free list from its head, & the released chunks (last reused first) */
+  std::vector<size_t> FreeList() const;
+  const std::vector<size_t>& Released() const { return released_; }
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  std::vector<Chunk> chunks_;      // null if released
+  std::vector<uint32_t> live_;     // slots not free per chunk
+  std::vector<size_t> released_;   // released chunks
+  size_t size_{0}, num_free_{0};
+  Id head_{kNullId};  // of the free list
+  uint32_t gen_floor_{0};  // above the generations of dropped slots
+  size_t spare_{size_t(-1)};  // the chunk emptied last, if still empty
+
+  // map a chunk of default slots
+  static Chunk NewChunk();
+
+  Slot& At(size_t i) { return chunks_[i >> kChunkBits][i & (kChunk - 1)]; }
+  const Slot& At(size_t i) const {
+    return chunks_[i >> kChunkBits][i & (kChunk - 1)];
+  }
+  /* end of the slots of chunk `c` */
+  size_t ChunkEnd(size_t c) const {
+    return std::min(size_, (c + 1) << kChunkBits);
+  }
+  // push slot `i` to the head of the free list / remove it from the list,
+  // the links are kept in `bl` (previous) & `tr` (next)
+  void Link(size_t i);
+  void Unlink(size_t i);
+  // append a slot, allocating a chunk if needed
+  size_t Append();
+  // raise `gen_floor_` above the slots [begin, end) of chunk `c`
+  void Drop(size_t c, size_t begin, size_t end);
+  void Release(size_t c);
+  // reallocate the released chunk `c` & link its slots
+  void Reuse(size_t c);
+};
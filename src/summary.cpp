@@ -0,0 +1,69 @@
+#include "summary.hpp"
+
+Summary::Summary(const Tile& plane, int depth)
+    : plane_(plane), depth_(depth), levels_(depth + 1) {
+  for (int k = 0; k <= depth; k++) levels_[k].resize(size_t(1) << (2 * k));
+}
+
+void Summary::Bounds(int k, size_t ix, size_t iy, Pt& lo, Pt& hi) const {
+  Len n = Len(size_t(1) << k);
+  lo = Pt(plane_.coord.x + plane_.size.x / n * ix,
+          plane_.coord.y + plane_.size.y / n * iy);
+  hi = Pt(plane_.coord.x + plane_.size.x / n * (ix + 1),
+          plane_.coord.y + plane_.size.y / n * (iy + 1));
+}
+
+/* closed rectangles [`lo`, `hi`] & `t` overlap? */
+static bool Touch(const Pt& lo, const Pt& hi, const Tile& t) {
+  auto t_hi = t.UpperRightCorner();
+  return t.coord.x <= hi.x && lo.x <= t_hi.x && t.coord.y <= hi.y &&
+         lo.y <= t_hi.y;
+}
+
+/* closed rectangle [`lo`, `hi`] lies inside `t`? */
+static bool Inside(const Pt& lo, const Pt& hi, const Tile& t) {
+  auto t_hi = t.UpperRightCorner();
+  return t.coord.x <= lo.x && hi.x <= t_hi.x && t.coord.y <= lo.y &&
+         hi.y <= t_hi.y;
+}
+
+void Summary::Update(const Tile& tile, int delta) {
+  Update(tile, delta, 0, 0, 0);
+}
+
+void Summary::Update(const Tile& tile, int delta, int k, size_t ix,
+                     size_t iy) {
+  Pt lo, hi;
+  Bounds(k, ix, iy, lo, hi);
+  if (!Touch(lo, hi, tile)) return;
+  auto& node = levels_[k][(iy << k) + ix];
+  if (Inside(lo, hi, tile)) {
+    node.cover += delta;
+    return;
+  }
+  node.count += delta;
+  if (k == depth_) return;
+  for (size_t dy = 0; dy < 2; dy++)
+    for (size_t dx = 0; dx < 2; dx++)
+      Update(tile, delta, k + 1, 2 * ix + dx, 2 * iy + dy);
+}
+
+bool Summary::MayOverlap(const Tile& area) const {
+  return MayOverlap(area, 0, 0, 0);
+}
+
+bool Summary::MayOverlap(const Tile& area, int k, size_t ix,
+                         size_t iy) const {
+  Pt lo, hi;
+  Bounds(k, ix, iy, lo, hi);
+  if (!Touch(lo, hi, area)) return false;
+  const auto& node = levels_[k][(iy << k) + ix];
+  if (node.cover) return true;
+  if (!node.count) return false;
+  // some tile partially overlaps the node, which lies inside the area
+  if (k == depth_ || Inside(lo, hi, area)) return true;
+  for (size_t dy = 0; dy < 2; dy++)
+    for (size_t dx = 0; dx < 2; dx++)
+      if (MayOverlap(area, k + 1, 2 * ix + dx, 2 * iy + dy)) return true;
+  return false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "tile.hpp"
+
+// A fixed-depth quadtree summarizing where solid tiles lie in a plane.
+// A tile covering a node is counted in `cover` of that node only, a tile
+// partially overlapping a node is counted in `count` and passed to the
+// children. Boundaries are treated as closed, so the summary may report
+// false positives near solid tiles but never misses one.
+class Summary {
+ public:
+  Summary() = delete;
+  Summary(const Summary& summary) = default;
+  Summary(const Tile& plane, int depth);
+
+  // deepest summary restored from bytes, its last level takes 128 MiB
+  static constexpr int kMaxDepth = 12;
+
+  int Depth() const { return depth_; }
+  /* record a solid tile */
+  void Add(const Tile& tile) { Update(tile, 1); }
+  /* forget a solid tile recorded by `Add` */
+  void Remove(const Tile& tile) { Update(tile, -1); }
+  // false if no solid tile overlaps `area` for sure
+  bool MayOverlap(const Tile& area) const;
+
+#ifdef GTEST
+ public:
+#else
+ protected:
+#endif
+  struct Node {
+    int count{0};  // tiles partially overlapping the node
+    int cover{0};  // tiles covering the node
+  };
+  Tile plane_;
+  int depth_;
+  std::vector<std::vector<Node>> levels_;  // 2^k x 2^k nodes at level k
+
+  // the region of node (`ix`, `iy`) at level `k`
+  void Bounds(int k, size_t ix, size_t iy, Pt& lo, Pt& hi) const;
+  void Update(const Tile& tile, int delta);
+  void Update(const Tile& tile, int delta, int k, size_t ix, size_t iy);
+  bool MayOverlap(const Tile& area, int k, size_t ix, size_t iy) const;
+};
@@ -78,7 +78,8 @@ struct Tile {
   bool Contain(const Pt& p) const { return CmpX(p.x) == EQ && CmpY(p.y) == EQ; }
   /* `t` lies inside this tile? */
   bool Contain(const Tile& t) const {
-    return Contain(t.coord) && !t.Contain(coord + size);
+    return Contain(t.coord) && (t.coord.x + t.size.x) <= (coord.x + size.x) &&
+           (t.coord.y + t.size.y) <= (coord.y + size.y);
   }
 
   /* `t` and this tile overlaps along x-axis? */
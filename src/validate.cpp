@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include "stitch.hpp"
+
+int Stitch::ValidateTile(Id id) const {
+  if (!Exist(id)) return 1;
+  const Tile plane(coord_, size_);
+  const auto& t = Ref(id);
+  const auto ll = t.LowerLeftCorner(), ur = t.UpperRightCorner();
+  const auto plane_ll = plane.LowerLeftCorner(),
+             plane_ur = plane.UpperRightCorner();
+  // lies inside the plane with area
+  if (!(t.size.x > 0 && t.size.y > 0 && plane_ll.x <= ll.x &&
+        plane_ll.y <= ll.y && ur.x <= plane_ur.x && ur.y <= plane_ur.y))
+    return 1;
+  // each stitch points to the tile beside the corresponding corner,
+  // or to nothing at the plane boundary
+  if (!Exist(t.tr) ? (t.tr != kNullId || ur.x != plane_ur.x)
+                   : !(Ref(t.tr).coord.x == ur.x && Ref(t.tr).coord.y < ur.y &&
+                       ur.y <= Ref(t.tr).UpperRightCorner().y))
+    return 1;
+  if (!Exist(t.rt) ? (t.rt != kNullId || ur.y != plane_ur.y)
+                   : !(Ref(t.rt).coord.y == ur.y && Ref(t.rt).coord.x < ur.x &&
+                       ur.x <= Ref(t.rt).UpperRightCorner().x))
+    return 1;
+  if (!Exist(t.bl) ? (t.bl != kNullId || ll.x != plane_ll.x)
+                   : !(Ref(t.bl).UpperRightCorner().x == ll.x &&
+                       Ref(t.bl).CmpY(ll.y) == Tile::EQ))
+    return 1;
+  if (!Exist(t.lb) ? (t.lb != kNullId || ll.y != plane_ll.y)
+                   : !(Ref(t.lb).UpperRightCorner().y == ll.y &&
+                       Ref(t.lb).CmpX(ll.x) == Tile::EQ))
+    return 1;
+  // neighbors of each side cover the whole edge without gap or overlap
+  auto covers = [](const std::vector<Id>& neighbors, Len from, Len to,
+                   auto lower, auto upper) {
+    Len cut = to;  // neighbors are visited from `to` down to `from`
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      if (upper(neighbors[i]) < cut || (i > 0 && upper(neighbors[i]) > cut))
+        return false;
+      cut = lower(neighbors[i]);
+    }
+    return neighbors.empty() || cut <= from;
+  };
+  auto bottom = [&](Id i) { return Ref(i).coord.y; };
+  auto top = [&](Id i) { return Ref(i).UpperRightCorner().y; };
+  auto left = [&](Id i) { return Ref(i).coord.x; };
+  auto right = [&](Id i) { return Ref(i).UpperRightCorner().x; };
+  auto neg = [](auto f) { return [f](Id i) { return -f(i); }; };
+  auto rights = RightNeighborFinding(id), lefts = LeftNeighborFinding(id);
+  auto tops = TopNeighborFinding(id), bottoms = BottomNeighborFinding(id);
+  if (!covers(rights, ll.y, ur.y, bottom, top) ||          // top to down
+      !covers(lefts, -ur.y, -ll.y, neg(top), neg(bottom)) ||  // bottom to up
+      !covers(tops, ll.x, ur.x, left, right) ||             // right to left
+      !covers(bottoms, -ur.x, -ll.x, neg(right), neg(left)))  // left to right
+    return 1;
+  if (Exist(t.tr) != (rights.size() > 0) || Exist(t.bl) != (lefts.size() > 0) ||
+      Exist(t.rt) != (tops.size() > 0) || Exist(t.lb) != (bottoms.size() > 0))
+    return 1;
+  // space tiles are maximal horizontal strips
+  if (t.is_space) {
+    for (const auto* side : {&rights, &lefts})
+      for (auto i : *side)
+        if (Ref(i).is_space) return 1;
+    for (auto i : {t.lb, t.rt})
+      if (Exist(i) && Ref(i).is_space && Ref(i).coord.x == ll.x &&
+          Ref(i).size.x == t.size.x)
+        return 1;
+  }
+  return 0;
+}
+
+std::vector<Id> Stitch::Validate() const {
+  std::vector<Id> invalid;
+  Id corner = kNullId;
+  for (auto id : Tiles()) {
+    if (ValidateTile(id)) invalid.push_back(id);
+    if (Ref(id).coord == coord_) corner = id;
+  }
+  // tiles whose edges are covered by their neighbors or the plane boundary
+  // tile the plane iff all of them are reached from the corner
+  std::vector<bool> reached(NumSlots(), false);
+  std::vector<Id> stack;
+  size_t n = 0;
+  auto visit = [&](Id id) {
+    if (!Exist(id) || reached[id]) return;
+    reached[id] = true;
+    stack.push_back(id);
+    n++;
+  };
+  visit(corner);
+  while (stack.size()) {
+    const auto& t = Ref(stack.back());
+    stack.pop_back();
+    for (auto i : {t.bl, t.lb, t.tr, t.rt}) visit(i);
+  }
+  if (!n || n != NumTiles()) invalid.push_back(kNullId);
+  return invalid;
+}
+
+std::vector<Id> Stitch::ValidateTouched() const {
+  std::vector<Id> ids;
+  for (auto id : touched_) {
+    if (!Exist(id)) continue;  // freed by merge
+    ids.push_back(id);
+    for (auto n : {RightNeighborFinding(id), TopNeighborFinding(id),
+                   LeftNeighborFinding(id), BottomNeighborFinding(id)})
+      ids.insert(ids.end(), n.begin(), n.end());
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  std::vector<Id> invalid;
+  for (auto id : ids)
+    if (ValidateTile(id)) invalid.push_back(id);
+  return invalid;
+}
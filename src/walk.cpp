@@ -0,0 +1,53 @@
+#include "stitch.hpp"
+
+Id Stitch::Along(Id id, const Pt& p, Dir dir) const {
+  const auto& t = Ref(id);
+  Id i = kNullId;
+  switch (dir) {
+    case EAST:  // go to tr, then trace down through lb
+      for (i = t.tr; Exist(i) && Ref(i).CmpY(p) == Tile::LT;) i = Ref(i).lb;
+      break;
+    case WEST:  // go to bl, then trace up through rt
+      for (i = t.bl; Exist(i) && Ref(i).CmpY(p) == Tile::GT;) i = Ref(i).rt;
+      break;
+    case NORTH:  // go to rt, then trace left through bl
+      for (i = t.rt; Exist(i) && Ref(i).CmpX(p) == Tile::LT;) i = Ref(i).bl;
+      break;
+    case SOUTH:  // go to lb, then trace right through tr
+      for (i = t.lb; Exist(i) && Ref(i).CmpX(p) == Tile::GT;) i = Ref(i).tr;
+      break;
+  }
+  return i;
+}
+
+std::vector<Id> Stitch::SegmentWalk(const Pt& p, Len length, Dir dir,
+                                    bool stop_at_solid, Id start) const {
+  std::vector<Id> ids;
+  if (length < 0 || !Plane().Contain(p)) return ids;
+  // a later tile is crossed if it starts before the end of the segment
+  const Len end = dir == EAST    ? p.x + length
+                  : dir == NORTH ? p.y + length
+                  : dir == WEST  ? p.x - length
+                                 : p.y - length;
+  auto crossed = [&](const Tile& t) {
+    switch (dir) {
+      case EAST: return t.coord.x < end;
+      case NORTH: return t.coord.y < end;
+      case WEST: return t.UpperRightCorner().x > end;
+      default: return t.UpperRightCorner().y > end;
+    }
+  };
+  for (Id id = PointFinding(p, start); Exist(id); id = Along(id, p, dir)) {
+    if (ids.size() && !crossed(Ref(id))) break;
+    ids.push_back(id);
+    if (stop_at_solid && !Ref(id).is_space) break;
+  }
+  return ids;
+}
+
+Id Stitch::RayShoot(const Pt& p, Dir dir, Id start) const {
+  if (!Plane().Contain(p)) return kNullId;
+  for (Id id = PointFinding(p, start); Exist(id); id = Along(id, p, dir))
+    if (!Ref(id).is_space) return id;
+  return kNullId;
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Client of the stitchd plane server (see src/protocol.hpp)."""
+
+import socket
+import struct
+from typing import List, Optional, Sequence, Tuple
+
+CREATE, DROP, INSERT, DELETE, TILE, POINT_FIND, AREA_SEARCH, AREA_ENUM = range(8)
+
+# (id, (x, y, w, h), is_space)
+Tile = Tuple[int, Tuple[float, float, float, float], bool]
+
+
+class Response:
+    def __init__(self, seq: int, status: int, tiles: List[Tile]):
+        self.seq = seq
+        self.status = status
+        self.tiles = tiles
+
+    @property
+    def ids(self) -> List[int]:
+        return [t[0] for t in self.tiles]
+
+
+class Client:
+    """Blocking client, `call` pipelines a batch of requests."""
+
+    def __init__(self, path: str):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.seq = 0
+        self.buf = b""
+
+    def close(self) -> None:
+        self.sock.close()
+
+    def __enter__(self) -> "Client":
+        return self
+
+    def __exit__(self, *_) -> None:
+        self.close()
+
+    @staticmethod
+    def request(op: int, plane: str, arg: Sequence = ()) -> Tuple:
+        """A request to pass to `call`, `arg` is (x, y, w, h), (x, y) or id."""
+        return (op, plane, arg)
+
+    def _encode(self, op: int, plane: str, arg) -> bytes:
+        self.seq += 1
+        name = plane.encode()
+        body = struct.pack("=IBH", self.seq, op, len(name)) + name
+        if op in (CREATE, INSERT, AREA_SEARCH, AREA_ENUM):
+            body += struct.pack("=4d", *arg)
+        elif op in (DELETE, TILE):
+            body += struct.pack("=i", arg)
+        elif op == POINT_FIND:
+            body += struct.pack("=2d", *arg)
+        return struct.pack("=I", len(body)) + body
+
+    def _recv(self, n: int) -> bytes:
+        while len(self.buf) < n:
+            chunk = self.sock.recv(1 << 16)
+            if not chunk:
+                raise ConnectionError("connection closed by server")
+            self.buf += chunk
+        data, self.buf = self.buf[:n], self.buf[n:]
+        return data
+
+    def call(self, requests: Sequence[Tuple]) -> List[Response]:
+        self.sock.sendall(b"".join(self._encode(*r) for r in requests))
+        responses = []
+        for _ in requests:
+            (length,) = struct.unpack("=I", self._recv(4))
+            body = self._recv(length)
+            seq, status, n = struct.unpack_from("=IiI", body)
+            tiles = [
+                (t[0], t[1:5], bool(t[5]))
+                for t in struct.iter_unpack("=i4dB", body[12:])
+            ]
+            assert len(tiles) == n
+            responses.append(Response(seq, status, tiles))
+        return responses
+
+    def _one(self, op: int, plane: str, arg=()) -> Response:
+        return self.call([(op, plane, arg)])[0]
+
+    def create(self, plane: str, coord, size) -> int:
+        return self._one(CREATE, plane, (*coord, *size)).status
+
+    def drop(self, plane: str) -> int:
+        return self._one(DROP, plane).status
+
+    def insert(self, plane: str, coord, size) -> Optional[int]:
+        r = self._one(INSERT, plane, (*coord, *size))
+        return None if r.status else r.ids[0]
+
+    def delete(self, plane: str, id: int) -> Optional[Tile]:
+        r = self._one(DELETE, plane, id)
+        return None if r.status else r.tiles[0]
+
+    def at(self, plane: str, id: int) -> Optional[Tile]:
+        r = self._one(TILE, plane, id)
+        return None if r.status else r.tiles[0]
+
+    def point_finding(self, plane: str, pt) -> Optional[int]:
+        r = self._one(POINT_FIND, plane, tuple(pt))
+        return r.ids[0] if r.ids else None
+
+    def area_search(self, plane: str, coord, size) -> Optional[int]:
+        r = self._one(AREA_SEARCH, plane, (*coord, *size))
+        return r.ids[0] if r.ids else None
+
+    def area_enum(self, plane: str, coord, size) -> List[int]:
+        return self._one(AREA_ENUM, plane, (*coord, *size)).ids
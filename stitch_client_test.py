@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+import os
+import struct
+import subprocess
+import tempfile
+import time
+import unittest
+
+from stitch_client import *
+
+STITCHD = os.path.join(os.path.dirname(os.path.abspath(__file__)), "stitchd")
+
+
+@unittest.skipUnless(os.access(STITCHD, os.X_OK), "make stitchd first")
+class ClientTest(unittest.TestCase):
+    def setUp(self) -> None:
+        self.dir = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.dir.name, "stitchd.sock")
+        self.server = subprocess.Popen(
+            [STITCHD, self.path, "2"], stderr=subprocess.DEVNULL
+        )
+        for _ in range(500):
+            if os.path.exists(self.path):
+                break
+            time.sleep(0.01)
+        self.client = Client(self.path)
+
+    def tearDown(self) -> None:
+        self.client.close()
+        self.server.terminate()
+        self.assertEqual(0, self.server.wait(10))
+        self.dir.cleanup()
+
+    def test_round_trip(self):
+        c = self.client
+        self.assertEqual(0, c.create("p", (0, 0), (100, 100)))
+        a = c.insert("p", (10, 10), (20, 5))
+        b = c.insert("p", (50, 40), (10, 10))
+        self.assertIsNotNone(a)
+        self.assertIsNotNone(b)
+        self.assertEqual((a, (10, 10, 20, 5), False), c.at("p", a))
+        self.assertEqual(a, c.point_finding("p", (15, 12)))
+        self.assertEqual(b, c.area_search("p", (45, 35), (10, 10)))
+        ids = c.area_enum("p", (0, 0), (100, 100))
+        self.assertIn(a, ids)
+        self.assertIn(b, ids)
+        # the space around the solid tiles is enumerated too
+        self.assertGreater(len(ids), 2)
+        self.assertEqual((a, (10, 10, 20, 5), False), c.delete("p", a))
+        self.assertIsNone(c.at("p", a))
+        self.assertNotEqual(a, c.point_finding("p", (15, 12)))
+        self.assertIsNone(c.area_search("p", (0, 0), (40, 40)))
+        self.assertEqual(0, c.drop("p"))
+
+    def test_errors(self):
+        c = self.client
+        self.assertEqual(0, c.create("p", (0, 0), (100, 100)))
+        self.assertEqual(1, c.create("p", (0, 0), (10, 10)))
+        a = c.insert("p", (10, 10), (20, 5))
+        # overlapping & outside the plane
+        self.assertIsNone(c.insert("p", (20, 12), (20, 20)))
+        self.assertIsNone(c.insert("p", (90, 90), (20, 20)))
+        self.assertIsNone(c.point_finding("p", (200, 0)))
+        # deleted twice, a space tile & an id never handed out
+        self.assertIsNotNone(c.delete("p", a))
+        self.assertIsNone(c.delete("p", a))
+        self.assertIsNone(c.delete("p", c.point_finding("p", (5, 5))))
+        self.assertIsNone(c.delete("p", 1 << 30))
+        # a missing plane
+        self.assertIsNone(c.insert("q", (0, 0), (1, 1)))
+        self.assertIsNone(c.at("q", 0))
+        self.assertEqual([], c.area_enum("q", (0, 0), (1, 1)))
+        self.assertEqual(0, c.drop("p"))
+        self.assertEqual(1, c.drop("p"))
+
+    def test_pipeline(self):
+        c = self.client
+        rs = c.call(
+            [
+                c.request(CREATE, "p", (0, 0, 100, 100)),
+                c.request(INSERT, "p", (0, 0, 10, 10)),
+                c.request(INSERT, "q", (0, 0, 10, 10)),
+                c.request(INSERT, "p", (5, 5, 10, 10)),
+                c.request(POINT_FIND, "p", (1, 1)),
+                c.request(DROP, "q"),
+                c.request(DROP, "p"),
+            ]
+        )
+        # the replies come in order, failed ones tagged too
+        self.assertEqual(list(range(1, 8)), [r.seq for r in rs])
+        self.assertEqual([0, 0, 1, 1, 0, 1, 0], [r.status for r in rs])
+        self.assertEqual(rs[1].ids, rs[4].ids)
+
+    def test_bad_frame(self):
+        # an unknown op closes the connection, others are still served
+        name = b"p"
+        body = struct.pack("=IBH", 1, 99, len(name)) + name
+        self.client.sock.sendall(struct.pack("=I", len(body)) + body)
+        with self.assertRaises(ConnectionError):
+            self.client.call([self.client.request(DROP, "p")])
+        with Client(self.path) as c:
+            self.assertEqual(0, c.create("p", (0, 0), (1, 1)))
+
+
+if __name__ == "__main__":
+    unittest.main()
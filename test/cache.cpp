@@ -0,0 +1,47 @@
+#include "../src/cache.hpp"
+
+#include <random>
+
+#include "test_stitch.hpp"
+
+TEST(CachedStitch, Random) {
+  Stitch s({0, 0}, {100, 100});
+  CachedStitch c(s, 16);
+  std::vector<Tile> windows;
+  for (int i = 0; i < 20; i++)
+    windows.push_back({{Len(i % 5 * 20), Len(i / 5 * 25)}, {15, 20}});
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> x(0, 95), len(1, 5);
+  for (int step = 0; step < 300; step++) {
+    auto ids = s.Tiles();
+    Id id = ids[gen() % ids.size()];
+    if (gen() % 3 == 0 && !s.Ref(id).is_space)
+      c.Delete(id);
+    else
+      c.Insert({{Len(x(gen)), Len(x(gen))}, {Len(len(gen)), Len(len(gen))},
+                false});
+    // query a few windows twice, results always match the plane
+    for (int q = 0; q < 6; q++) {
+      const auto& w = windows[gen() % windows.size()];
+      ASSERT_EQ(s.AreaEnum(w), c.AreaEnum(w));
+      ASSERT_EQ(s.AreaEnum(w), c.AreaEnum(w));
+      ASSERT_EQ(s.AreaSearch(w), c.AreaSearch(w));
+    }
+  }
+  const auto& st = c.GetStats();
+  EXPECT_GE(st.hits, 300u * 6);
+  EXPECT_GT(st.invalidations, 0u);
+  EXPECT_GT(st.evictions, 0u);
+  EXPECT_LE(st.entries, 16u);
+  EXPECT_GT(st.bytes, 0u);
+  // an edit far away keeps the entry, the wall keeps the split strips away
+  Stitch t({0, 0}, {100, 100});
+  t.Insert({{50, 0}, {2, 100}, false});
+  CachedStitch d(t);
+  d.AreaEnum({{0, 0}, {10, 10}});
+  d.Insert({{80, 80}, {5, 5}, false});
+  d.AreaEnum({{0, 0}, {10, 10}});
+  EXPECT_EQ(1u, d.GetStats().hits);
+  d.Clear();
+  EXPECT_EQ(0u, d.GetStats().bytes);
+}
@@ -0,0 +1,190 @@
+#include "../src/concurrent.hpp"
+
+#include <random>
+#include <thread>
+
+#include "test_stitch.hpp"
+
+TEST(ConcurrentStitch, Rows) {
+  // each thread moves cells around in its own rows, anchored by a fixed
+  // solid tile at the left of its rows
+  const int threads = 4, cells = 6, steps = 300;
+  const Len row = 10, width = 200;
+  Stitch s({0, 0}, {width, row * threads});
+  std::vector<Id> anchors;
+  for (int t = 0; t < threads; t++)
+    anchors.push_back(s.Insert({{0, t * row + 2}, {2, 6}, false}));
+  ConcurrentStitch c(s, 1024);
+  std::vector<std::vector<Id>> placed(threads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<int> x(4, width - 10), y(0, row - 4),
+          len(1, 6);
+      std::vector<Id> ids;
+      for (int i = 0; i < steps; i++) {
+        if (ids.size() < cells) {
+          Tile tile({Len(x(gen)), t * row + y(gen)},
+                    {Len(len(gen)), Len(len(gen)) / 2}, false);
+          Id id = c.Insert(tile, anchors[t]);
+          if (id != kNullId) ids.push_back(id);
+        } else {
+          size_t k = gen() % ids.size();
+          EXPECT_TRUE(c.Delete(ids[k]).has_value());
+          ids.erase(ids.begin() + k);
+        }
+      }
+      placed[t] = ids;
+    });
+  for (auto& w : workers) w.join();
+  EXPECT_EQ(0, c.NumExclusive());
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+  TestStitch::CheckTiles(s);
+  TestStitch::CheckStrip(s);
+  size_t solids = 0;
+  for (auto id : s.Tiles()) solids += !s.Ref(id).is_space;
+  size_t expect = anchors.size();
+  for (const auto& p : placed) {
+    expect += p.size();
+    for (auto id : p) EXPECT_FALSE(s.Ref(id).is_space);
+  }
+  EXPECT_EQ(expect, solids);
+  // without a hint a mutation runs exclusively
+  EXPECT_NE(kNullId, c.Insert({{100, 9}, {1, 1}, false}));
+  EXPECT_EQ(1, c.NumExclusive());
+}
+
+TEST(ConcurrentStitch, Closure) {
+  // the tiles written by a mutation lie inside the explored band
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> pos(0, 38), len(1, 8), coin(0, 2);
+  Stitch s({0, 0}, {40, 40});
+  ConcurrentStitch c(s, 256);
+  Id anchor = s.Insert({{0, 0}, {1, 1}, false});
+  std::vector<Id> ids;
+  auto inside = [&](Id id, const ConcurrentStitch::Band& band) {
+    if (!s.Exist(id)) return true;
+    const auto& t = s.Ref(id);
+    return band.lo <= t.coord.y && t.UpperLeftCorner().y <= band.hi;
+  };
+  for (int i = 0; i < 400; i++) {
+    ConcurrentStitch::Band band;
+    s.TrackTouched(true);
+    if (coin(gen) || ids.empty()) {
+      Tile tile({Len(pos(gen)), Len(pos(gen))},
+                {Len(len(gen)), Len(len(gen))}, false);
+      if (!s.Plane().Contain(tile)) continue;
+      band = {tile.coord.y, tile.UpperLeftCorner().y};
+      Id start = kNullId;
+      size_t slots = 0;
+      auto status = ConcurrentStitch::WIDEN;
+      while (status == ConcurrentStitch::WIDEN)
+        status = c.PlanInsert(tile, anchor, band, start, slots);
+      if (status == ConcurrentStitch::OVERLAP) {
+        EXPECT_EQ(kNullId, s.Insert(tile));
+        continue;
+      }
+      // the reserved slots suffice
+      std::vector<size_t> pool;
+      ASSERT_EQ(0, c.Take(slots, pool));
+      Id id = c.Run(pool, [&] { return s.Insert(tile, start); });
+      c.Give(pool);
+      ASSERT_NE(kNullId, id);
+      ids.push_back(id);
+    } else {
+      size_t k = gen() % ids.size();
+      const auto t = s.Ref(ids[k]);
+      band = {t.coord.y, t.UpperLeftCorner().y};
+      std::vector<Id> tiles;
+      while (c.Explore({ids[k]}, ConcurrentStitch::kDeleteDepth, band, tiles) ==
+             ConcurrentStitch::WIDEN)
+        continue;
+      std::vector<size_t> pool;
+      ASSERT_EQ(0, c.Take(c.DeleteSlots(ids[k]), pool));
+      c.Run(pool, [&] { return s.Delete(ids[k]); });
+      c.Give(pool);
+      ids.erase(ids.begin() + k);
+    }
+    for (auto id : s.touched_) EXPECT_TRUE(inside(id, band)) << i;
+  }
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+}
+
+TEST(ConcurrentStitch, DoubleDelete) {
+  // threads race to delete the same tiles, each is returned once
+  const int threads = 4, cells = 50;
+  Stitch s({0, 0}, {1000, 100});
+  std::vector<Id> ids;
+  for (int i = 0; i < cells; i++)
+    ids.push_back(s.Insert({{Len(i * 20), Len(i % 5 * 20)}, {10, 10}, false}));
+  ConcurrentStitch c(s, 1024);
+  std::vector<int> deleted(cells, 0);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back([&, t] {
+      std::vector<int> mine(cells, 0);
+      for (int i = 0; i < cells; i++) {
+        int k = (t % 2) ? cells - 1 - i : i;
+        mine[k] = c.Delete(ids[k]).has_value();
+      }
+      static std::mutex m;
+      std::lock_guard<std::mutex> lock(m);
+      for (int i = 0; i < cells; i++) deleted[i] += mine[i];
+    });
+  for (auto& w : workers) w.join();
+  for (int i = 0; i < cells; i++) EXPECT_EQ(1, deleted[i]) << i;
+  EXPECT_EQ(1u, s.NumTiles());
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+}
+
+TEST(ConcurrentStitch, DryPool) {
+  // a mutation running out of its reserved slots takes free ones
+  Stitch s({0, 0}, {10, 10});
+  ConcurrentStitch c(s, 16);
+  size_t free = s.tiles_.NumFree();
+  std::vector<size_t> pool;
+  Id id = c.Run(pool, [&] { return s.Insert({{2, 2}, {2, 2}, false}); });
+  ASSERT_NE(kNullId, id);
+  EXPECT_EQ(5u, s.NumTiles());
+  EXPECT_EQ(free - 4, s.tiles_.NumFree() + pool.size());
+  c.Give(pool);
+  EXPECT_EQ(free - 4, s.tiles_.NumFree());
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+}
+
+TEST(ConcurrentStitch, DeleteReused) {
+  // tiles are deleted twice while other threads reuse their slots, an id
+  // names whatever solid tile holds its slot when it is deleted
+  const int threads = 4, cells = 40, rounds = 20;
+  Stitch s({0, 0}, {1000, 100});
+  std::vector<Id> ids;
+  for (int i = 0; i < cells; i++)
+    ids.push_back(s.Insert({{Len(i * 20), 0}, {10, 10}, false}));
+  Id anchor = s.Insert({{0, 60}, {1, 1}, false});
+  ConcurrentStitch c(s, 1024);
+  std::atomic<int> inserted{0}, deleted{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back([&, t] {
+      if (t % 2) {  // insert & delete in the upper rows
+        for (int r = 0; r < rounds; r++)
+          for (int i = 0; i < cells / 2; i++) {
+            Id id = c.Insert({{Len(i * 20 + 5), Len(40 + t * 10)}, {5, 5},
+                              false},
+                             anchor);
+            if (id == kNullId) continue;
+            inserted++;
+            deleted += c.Delete(id).has_value();
+          }
+      } else {
+        for (int i = 0; i < cells; i++) deleted += c.Delete(ids[i]).has_value();
+      }
+    });
+  for (auto& w : workers) w.join();
+  size_t solids = 0;
+  for (auto id : s.Tiles()) solids += !s.Ref(id).is_space;
+  EXPECT_EQ(size_t(cells + 1 + inserted - deleted), solids);
+  EXPECT_FALSE(s.Ref(anchor).is_space);
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+}
@@ -0,0 +1,61 @@
+#include "../src/dual.hpp"
+
+#include "test_stitch.hpp"
+
+TEST(DualStitch, InsertDelete) {
+  DualStitch d({0, 0}, {30, 24});
+  std::vector<Tile> solids = {
+      {{15, 2}, {5, 5}},  {{20, 2}, {8, 2}},  {{4, 5}, {5, 8}},
+      {{11, 11}, {8, 4}}, {{19, 14}, {6, 4}}, {{7, 18}, {6, 4}},
+  };
+  std::vector<Id> ids;
+  for (const auto& t : solids) ids.push_back(d.Insert(t));
+  EXPECT_EQ(kNullId, d.Insert({{27, 1}, {2, 4}}));
+  for (const auto* s : {&d.Horizontal(), &d.Vertical()}) {
+    TestStitch::CheckNeighbors(*s);
+    TestStitch::CheckTiles(*s);
+    TestStitch::CheckStrip(*s);
+  }
+  // the vertical strip spans the whole free column
+  EXPECT_EQ(Tile({0, 0}, {4, 24}), d.VerticalStrip({1, 12}));
+  EXPECT_EQ(Tile({0, 15}, {19, 3}), d.HorizontalStrip({1, 16}));
+  EXPECT_EQ(Tile({4, 5}, {5, 8}, false), d.VerticalStrip({5, 6}));
+  // both orientations find the same solid tiles
+  EXPECT_EQ(ids[2], d.AreaSearch({{2, 0}, {3, 24}}));
+  EXPECT_EQ(ids[2], d.AreaSearch({{0, 7}, {30, 1}}));
+  EXPECT_EQ(kNullId, d.AreaSearch({{0, 0}, {4, 24}}));
+  EXPECT_EQ(std::vector<Tile>{Tile({0, 0}, {4, 24})},
+            d.AreaEnum({{1, 1}, {2, 20}}));
+  // the right edge of a solid tile borders one vertical strip, but is cut
+  // into several horizontal ones
+  EXPECT_EQ(std::vector<Tile>{Tile({9, 0}, {2, 18})},
+            d.NeighborFinding(ids[2], Stitch::EAST));
+  EXPECT_EQ(3u, d.Horizontal().RightNeighborFinding(ids[2]).size());
+  EXPECT_EQ((std::vector<Tile>{{{20, 4}, {5, 10}}, {{20, 2}, {8, 2}, false}}),
+            d.NeighborFinding(ids[0], Stitch::EAST));
+  // the neighbors border the whole edge
+  for (auto dir : {Stitch::EAST, Stitch::NORTH, Stitch::WEST, Stitch::SOUTH})
+    for (auto id : ids) {
+      const auto& t = d.Horizontal().Ref(id);
+      bool lateral = dir == Stitch::EAST || dir == Stitch::WEST;
+      Len covered = 0;
+      for (const auto& n : d.NeighborFinding(id, dir))
+        covered += lateral ? std::min(n.UpperLeftCorner().y,
+                                      t.UpperLeftCorner().y) -
+                                 std::max(n.coord.y, t.coord.y)
+                           : std::min(n.LowerRightCorner().x,
+                                      t.LowerRightCorner().x) -
+                                 std::max(n.coord.x, t.coord.x);
+      EXPECT_FLOAT_EQ(lateral ? t.size.y : t.size.x, covered) << id << dir;
+    }
+  // a tile the planes disagree on is not inserted into either
+  size_t n = d.Horizontal().NumTiles();
+  Id v = d.v_.Insert({{0, 0}, {1, 1}, false});
+  EXPECT_EQ(kNullId, d.Insert({{0, 0}, {1, 1}}));
+  EXPECT_EQ(n, d.Horizontal().NumTiles());
+  EXPECT_TRUE(d.Horizontal().Validate().empty());
+  d.v_.Delete(v);
+  for (auto id : ids) EXPECT_TRUE(d.Delete(id).has_value());
+  EXPECT_EQ(1, d.Horizontal().NumTiles());
+  EXPECT_EQ(1, d.Vertical().NumTiles());
+}
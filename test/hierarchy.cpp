@@ -0,0 +1,102 @@
+#include "../src/hierarchy.hpp"
+
+#include <random>
+
+#include "test_stitch.hpp"
+
+TEST(Hierarchy, Query) {
+  Stitch cell({0, 0}, {10, 8});
+  cell.Insert({{1, 1}, {3, 6}, false});
+  cell.Insert({{5, 2}, {4, 2}, false});
+  Hierarchy h({0, 0}, {60, 40});
+  auto c = h.AddCell(cell);
+  EXPECT_EQ(std::nullopt, h.Place(c, {55, 0}));  // sticks out
+  EXPECT_EQ(std::nullopt, h.Place(c + 1, {0, 0}));
+  EXPECT_EQ(std::nullopt, h.Place(c, {-1, 0}));  // off quadrant I
+  for (const Pt& offset : {Pt(0, 0), Pt(10, 0), Pt(20, 16), Pt(42, 30)})
+    EXPECT_TRUE(h.Place(c, offset).has_value());
+  h.Top().Insert({{30, 4}, {6, 6}, false});
+  EXPECT_EQ(Tile({20, 16}, {10, 8}), h.Bounds(2));
+
+  auto hit = h.PointFinding({12, 3});
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(1, hit->instance);
+  EXPECT_EQ(Tile({11, 1}, {3, 6}, false), hit->tile);
+  EXPECT_EQ(Hierarchy::kTop, h.PointFinding({31, 5})->instance);
+  EXPECT_EQ(std::nullopt, h.PointFinding({14.5, 3}));
+  EXPECT_EQ(std::nullopt, h.AreaSearch({{0, 30}, {40, 10}}));
+  EXPECT_EQ(3, h.AreaSearch({{45, 30}, {2, 2}})->instance);
+
+  // queries agree with the flattened plane
+  auto flat = h.Flatten();
+  EXPECT_EQ(1 + 2 * 4, (int)h.AreaEnum(flat.Plane()).size());
+  for (const Tile& area :
+       {Tile({0, 0}, {60, 40}), Tile({8, 2}, {15, 16}), Tile({33, 9}, {12, 25}),
+        Tile({0, 8}, {20, 8})}) {
+    std::vector<Tile> expect, got;
+    for (auto id : flat.AreaEnum(area))
+      if (!flat.Ref(id).is_space)
+        expect.push_back(Tile(flat.Ref(id).coord, flat.Ref(id).size, false));
+    for (const auto& hit : h.AreaEnum(area)) got.push_back(hit.tile);
+    auto less = [](const Tile& l, const Tile& r) {
+      return std::make_pair(l.coord.x, l.coord.y) <
+             std::make_pair(r.coord.x, r.coord.y);
+    };
+    std::sort(expect.begin(), expect.end(), less);
+    std::sort(got.begin(), got.end(), less);
+    EXPECT_EQ(expect, got);
+    EXPECT_EQ(expect.empty(), !h.AreaSearch(area).has_value());
+  }
+}
+
+TEST(Hierarchy, Touch) {
+  Stitch cell({0, 0}, {4, 4});
+  cell.Insert({{0, 0}, {4, 4}, false});
+  Hierarchy h({0, 0}, {20, 20});
+  auto c = h.AddCell(cell);
+  ASSERT_TRUE(h.Place(c, {10, 10}).has_value());
+  // areas touching the instance from outside hold none of it
+  for (const Tile& area : {Tile({8, 10}, {2, 4}), Tile({14, 10}, {2, 4}),
+                           Tile({10, 8}, {4, 2}), Tile({10, 14}, {4, 2}),
+                           Tile({6, 6}, {4, 4})}) {
+    EXPECT_EQ(std::nullopt, h.AreaSearch(area)) << area;
+    EXPECT_TRUE(h.AreaEnum(area).empty()) << area;
+  }
+  EXPECT_EQ(std::nullopt, h.PointFinding({14, 12}));
+  EXPECT_EQ(0, h.PointFinding({10, 10})->instance);
+  EXPECT_EQ(1u, h.AreaEnum({{9, 9}, {2, 2}}).size());
+}
+
+TEST(Hierarchy, Buckets) {
+  // instances spread over the plane, a larger cell placed midway
+  Stitch small({0, 0}, {3, 2}), large({0, 0}, {12, 9});
+  small.Insert({{0, 0}, {2, 2}, false});
+  large.Insert({{1, 1}, {10, 7}, false});
+  Hierarchy h({0, 0}, {200, 200});
+  auto s = h.AddCell(small), l = h.AddCell(large);
+  std::mt19937 gen(5);
+  for (int i = 0; i < 300; i++) {
+    auto cell = i == 150 ? l : s;
+    h.Place(cell, {Len(gen() % 188), Len(gen() % 190)});
+  }
+  // buckets as large as the largest cell, the instances spread over them
+  EXPECT_EQ(12, h.bucket_);
+  EXPECT_GT(h.buckets_.size(), 100u);
+  for (int k = 0; k < 50; k++) {
+    Tile area({Len(gen() % 190), Len(gen() % 190)},
+              {Len(gen() % 30), Len(gen() % 30)});
+    std::vector<size_t> expect, got;
+    for (size_t i = 0; i < h.NumInstances(); i++) {
+      const auto& cell = h.Cell(h.At(i).cell);
+      for (auto id : cell.Tiles())
+        if (!cell.Ref(id).is_space &&
+            Tile(cell.Ref(id).coord + h.At(i).offset, cell.Ref(id).size)
+                .Overlap(area))
+          expect.push_back(i);
+    }
+    for (const auto& hit : h.AreaEnum(area)) got.push_back(hit.instance);
+    std::sort(expect.begin(), expect.end());
+    std::sort(got.begin(), got.end());
+    EXPECT_EQ(expect, got) << area;
+  }
+}
@@ -0,0 +1,98 @@
+#include "../src/io.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include "test_stitch.hpp"
+
+TEST(Import, Text) {
+  std::string path = testing::TempDir() + "stitch_import.txt";
+  std::ofstream(path) << "# x y w h label\n"
+                      << "15 2 5 5 a\n"
+                      << "20 2 8 2\n"
+                      << "\n"
+                      << "4 5 5 8 c d\n"
+                      << "11 11 8\n"            // parse error
+                      << "11 11 8 4\n"
+                      << "19 14 6 4 e\n"
+                      << "27 1 2 4\n"           // overlap
+                      << "25 20 6 1\n"          // out of plane
+                      << "7 18 6 4";
+  for (size_t batch : {1, 7, 1 << 20}) {
+    for (size_t threads : {1, 3}) {
+      Stitch s({0, 0}, {30, 24});
+      auto r = ImportText(s, path, threads, batch);
+      EXPECT_EQ(0, r.status);
+      EXPECT_EQ(6, r.ids.size());
+      EXPECT_EQ((std::vector<std::string>{"a", "", "c d", "", "e", ""}),
+                r.labels);
+      ASSERT_EQ(3, r.errors.size());
+      EXPECT_EQ(ImportError::PARSE, r.errors[0].kind);
+      EXPECT_EQ(5, r.errors[0].record);
+      EXPECT_EQ(ImportError::OVERLAP, r.errors[1].kind);
+      EXPECT_EQ(8, r.errors[1].record);
+      EXPECT_EQ(Tile({27, 1}, {2, 4}, false), r.errors[1].tile);
+      EXPECT_EQ(ImportError::OUT_OF_PLANE, r.errors[2].kind);
+      EXPECT_EQ(9, r.errors[2].record);
+      EXPECT_EQ(std::vector<Id>{}, s.Validate());
+      TestStitch::CheckNeighbors(s);
+    }
+  }
+  std::remove(path.c_str());
+  Stitch s({0, 0}, {30, 24});
+  EXPECT_EQ(1, ImportText(s, path).status);
+}
+
+TEST(Import, Binary) {
+  std::string path = testing::TempDir() + "stitch_import.bin";
+  std::vector<Len> data = {15, 2, 5, 5, 20, 2, 8,  2,  4,  5,  5,  8,
+                           27, 1, 2, 4, 11, 11, 8, 4, 7, 18, 6, 4, 1};
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(data.data()),
+             data.size() * sizeof(Len));
+  for (size_t batch : {32, 1 << 20}) {
+    Stitch s({0, 0}, {30, 24});
+    auto r = ImportBinary(s, path, 2, batch);
+    EXPECT_EQ(5, r.ids.size());
+    ASSERT_EQ(2, r.errors.size());
+    EXPECT_EQ(ImportError::OVERLAP, r.errors[0].kind);
+    EXPECT_EQ(3, r.errors[0].record);
+    EXPECT_EQ(ImportError::PARSE, r.errors[1].kind);
+    EXPECT_EQ(6, r.errors[1].record);
+    EXPECT_EQ(std::vector<Id>{}, s.Validate());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Import, Empty) {
+  // rectangles without area are rejected instead of reaching Insert
+  std::string path = testing::TempDir() + "stitch_import_empty.txt";
+  std::ofstream(path) << "10 10 0 0\n"
+                      << "10 10 0 5\n"
+                      << "10 10 5 0\n"
+                      << "10 10 -1 5\n"
+                      << "10 10 nan 5\n"
+                      << "10 10 5 5\n";
+  Stitch s({0, 0}, {30, 24});
+  auto r = ImportText(s, path);
+  EXPECT_EQ(1, r.ids.size());
+  ASSERT_EQ(5, r.errors.size());
+  for (size_t i = 0; i < r.errors.size(); i++) {
+    EXPECT_EQ(ImportError::EMPTY, r.errors[i].kind);
+    EXPECT_EQ(i, r.errors[i].record);
+  }
+  std::remove(path.c_str());
+  path = testing::TempDir() + "stitch_import_empty.bin";
+  std::vector<Len> data = {10, 10, 0, 0, 10, 10, 5, 0, 1, 1, 2, 2};
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(data.data()),
+             data.size() * sizeof(Len));
+  Stitch t({0, 0}, {30, 24});
+  r = ImportBinary(t, path);
+  EXPECT_EQ(1, r.ids.size());
+  ASSERT_EQ(2, r.errors.size());
+  EXPECT_EQ(ImportError::EMPTY, r.errors[0].kind);
+  EXPECT_EQ(ImportError::EMPTY, r.errors[1].kind);
+  EXPECT_EQ(std::vector<Id>{}, t.Validate());
+  std::remove(path.c_str());
+}
@@ -0,0 +1,76 @@
+#include "../src/journal.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <random>
+
+#include "test_stitch.hpp"
+
+/* the same tiles, free slots & last inserted tile */
+static void ExpectSame(const Stitch& a, const Stitch& b) {
+  EXPECT_EQ(a.Plane(), b.Plane());
+  EXPECT_EQ(a.tiles_, b.tiles_);
+  EXPECT_EQ(a.last_inserted_, b.last_inserted_);
+}
+
+/* random insertions & deletions through `j` */
+static void Mutate(Journal& j, Stitch& s, std::mt19937& gen, int steps) {
+  std::uniform_int_distribution<int> x(0, 90), len(1, 10);
+  for (int i = 0; i < steps; i++) {
+    auto ids = s.Tiles();
+    if (gen() % 3 == 0) {
+      Id id = ids[gen() % ids.size()];
+      if (!s.Ref(id).is_space) j.Delete(id);
+    } else {
+      j.Insert({{Len(x(gen)), Len(x(gen))}, {Len(len(gen)), Len(len(gen))},
+                false});
+    }
+  }
+}
+
+TEST(Journal, Recover) {
+  char tmpl[] = "/tmp/stitch_journal_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(tmpl));
+  std::string dir = tmpl;
+  EXPECT_FALSE(Stitch::Recover(dir).has_value());  // no checkpoint
+
+  std::mt19937 gen(1);
+  Stitch s({0, 0}, {100, 100});
+  {
+    Journal j(s, dir, 16, 150);
+    ASSERT_EQ(0, j.Open());
+    Mutate(j, s, gen, 400);
+    ASSERT_EQ(0, j.Sync());
+    EXPECT_LT(j.NumSyncs(), j.NumRecords());
+    auto r = Stitch::Recover(dir);
+    ASSERT_TRUE(r.has_value());
+    ExpectSame(s, *r);
+    EXPECT_TRUE(r->Validate().empty());
+    Mutate(j, s, gen, 50);
+  }  // synced when destroyed
+  auto r = Stitch::Recover(dir);
+  ASSERT_TRUE(r.has_value());
+  ExpectSame(s, *r);
+
+  // a torn record at the end is ignored
+  int fd = open((dir + "/journal").c_str(), O_WRONLY | O_APPEND);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(5, write(fd, "torn!", 5));
+  close(fd);
+  r = Stitch::Recover(dir);
+  ASSERT_TRUE(r.has_value());
+  ExpectSame(s, *r);
+
+  // continue journaling the recovered plane
+  {
+    Journal j(*r, dir);
+    ASSERT_EQ(0, j.Open());
+    Mutate(j, *r, gen, 50);
+  }
+  auto again = Stitch::Recover(dir);
+  ASSERT_TRUE(again.has_value());
+  ExpectSame(*r, *again);
+  std::system(("rm -rf " + dir).c_str());
+}
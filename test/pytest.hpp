@@ -10,56 +10,56 @@
 // get the existing tiles
 std::vector<PyTile> Tiles(PyStitch& s) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::Tiles(s.s_)) ret.push_back(PyTile(s.s_, id));
+  for (auto id : TestStitch::Tiles(*s.s_)) ret.push_back(PyTile(s.s_, id));
   return ret;
 }
 // get golden neighbors of tile by visiting all tiles
 std::vector<PyTile> GoldenLeftNeighbors(PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::GoldenNeighbors(t.s_, t.id_, LEFT))
+  for (auto id : TestStitch::GoldenNeighbors(*t.s_, t.id_, LEFT))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> GoldenBottomNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::GoldenNeighbors(t.s_, t.id_, BOTTOM))
+  for (auto id : TestStitch::GoldenNeighbors(*t.s_, t.id_, BOTTOM))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> GoldenRightNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::GoldenNeighbors(t.s_, t.id_, RIGHT))
+  for (auto id : TestStitch::GoldenNeighbors(*t.s_, t.id_, RIGHT))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> GoldenTopNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::GoldenNeighbors(t.s_, t.id_, TOP))
+  for (auto id : TestStitch::GoldenNeighbors(*t.s_, t.id_, TOP))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 // get neighbors of tile
 std::vector<PyTile> LeftNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::Neighbors(t.s_, t.id_, LEFT))
+  for (auto id : TestStitch::Neighbors(*t.s_, t.id_, LEFT))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> BottomNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::Neighbors(t.s_, t.id_, BOTTOM))
+  for (auto id : TestStitch::Neighbors(*t.s_, t.id_, BOTTOM))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> RightNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::Neighbors(t.s_, t.id_, RIGHT))
+  for (auto id : TestStitch::Neighbors(*t.s_, t.id_, RIGHT))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
 std::vector<PyTile> TopNeighbors(PyStitch& s, PyTile& t) {
   std::vector<PyTile> ret;
-  for (auto id : TestStitch::Neighbors(t.s_, t.id_, TOP))
+  for (auto id : TestStitch::Neighbors(*t.s_, t.id_, TOP))
     ret.push_back(PyTile(t.s_, id));
   return ret;
 }
@@ -76,7 +76,7 @@ std::vector<PyTile> TopNeighbors(PyStitch& s, PyTile& t) {
 // check neighbors & pointers of all tiles
 int CheckNeighbors(PyStitch& ps) {
   int ret = 0;
-  const auto& s = ps.s_;
+  const auto& s = *ps.s_;
   for (auto id : TestStitch::Tiles(s)) {
     const auto& t = s.Ref(id);
     auto rights = TestStitch::GoldenNeighbors(s, id, RIGHT);
@@ -97,7 +97,7 @@ int CheckNeighbors(PyStitch& ps) {
 // check no overlap between tiles & whole plane is covered
 int CheckTiles(PyStitch& ps) {
   int ret = 0;
-  const auto& s = ps.s_;
+  const auto& s = *ps.s_;
   std::vector<Id> ids = TestStitch::Tiles(s);
   Len area = 0;
   for (auto x : ids) {
@@ -112,7 +112,7 @@ int CheckTiles(PyStitch& ps) {
 // check maximum horizontal strip property
 bool CheckStrip(PyStitch& ps) {
   int ret = 0;
-  const auto& s = ps.s_;
+  const auto& s = *ps.s_;
   for (auto id : TestStitch::Tiles(s)) {
     const auto& tl = s.Ref(id);
     if (tl.is_space) {
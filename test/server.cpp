@@ -0,0 +1,126 @@
+#include "../src/server.hpp"
+
+#include <unistd.h>
+
+#include <thread>
+
+#include "../src/client.hpp"
+#include "test_stitch.hpp"
+
+TEST(Protocol, Frames) {
+  Request req;
+  req.seq = 7;
+  req.op = Request::AREA_ENUM;
+  req.plane = "metal1";
+  req.area = Tile({1, 2}, {3, 4});
+  std::string buf;
+  Encode(req, buf);
+  Encode(req, buf);
+  Request got;
+  size_t used = 0;
+  EXPECT_EQ(FRAME_INCOMPLETE, Decode(buf.data(), 3, used, got));
+  EXPECT_EQ(FRAME_INCOMPLETE, Decode(buf.data(), buf.size() / 2 - 1, used, got));
+  ASSERT_EQ(FRAME_OK, Decode(buf.data(), buf.size(), used, got));
+  EXPECT_EQ(buf.size() / 2, used);
+  EXPECT_EQ(7u, got.seq);
+  EXPECT_EQ(Request::AREA_ENUM, got.op);
+  EXPECT_EQ("metal1", got.plane);
+  EXPECT_EQ(req.area, got.area);
+
+  Response res;
+  res.seq = 3;
+  res.ids = {5};
+  res.tiles = {Tile({1, 1}, {2, 2}, false)};
+  buf.clear();
+  Encode(res, buf);
+  Response got_res;
+  ASSERT_EQ(FRAME_OK, Decode(buf.data(), buf.size(), used, got_res));
+  EXPECT_EQ(res.ids, got_res.ids);
+  EXPECT_EQ(res.tiles, got_res.tiles);
+  EXPECT_FALSE(got_res.tiles[0].is_space);
+  // a negative size is rejected
+  req.op = Request::INSERT;
+  req.area.size.x = -1;
+  buf.clear();
+  Encode(req, buf);
+  EXPECT_EQ(FRAME_BAD, Decode(buf.data(), buf.size(), used, got));
+}
+
+TEST(Server, Clients) {
+  auto path = "/tmp/stitch_test_" + std::to_string(getpid()) + ".sock";
+  Server server(path, 4);
+  ASSERT_EQ(0, server.Listen());
+  std::thread loop([&] { server.Run(); });
+
+  Client c;
+  ASSERT_EQ(0, c.Connect(path));
+  EXPECT_EQ(0, c.Create("a", {0, 0}, {100, 100}));
+  EXPECT_EQ(1, c.Create("a", {0, 0}, {100, 100}));
+  EXPECT_EQ(0, c.Create("b", {0, 0}, {50, 50}));
+  EXPECT_EQ(kNullId, c.Insert("missing", {{1, 1}, {2, 2}}));
+  Id id = c.Insert("a", {{10, 10}, {5, 5}});
+  ASSERT_NE(kNullId, id);
+  EXPECT_EQ(kNullId, c.Insert("a", {{12, 12}, {5, 5}}));  // overlaps
+  EXPECT_EQ(kNullId, c.Insert("a", {{30, 30}, {0, 0}}));  // no area
+  EXPECT_EQ(id, c.PointFinding("a", {11, 11}));
+  EXPECT_EQ(kNullId, c.PointFinding("a", {200, 11}));
+  EXPECT_EQ(id, c.AreaSearch("a", {{0, 0}, {20, 20}}));
+  EXPECT_EQ(kNullId, c.AreaSearch("b", {{0, 0}, {20, 20}}));
+  EXPECT_EQ(5u, c.AreaEnum("a", {{0, 0}, {200, 200}}).size());
+
+  // a pipelined batch mixing planes, reads & writes keeps request order
+  std::vector<Request> batch;
+  for (int i = 0; i < 8; i++) {
+    Request ins;
+    ins.op = Request::INSERT;
+    ins.plane = i % 2 ? "a" : "b";
+    ins.area = Tile({Len(i * 5), 30}, {2, 2});
+    batch.push_back(ins);
+    Request find;
+    find.op = Request::POINT_FIND;
+    find.plane = ins.plane;
+    find.pt = {i * 5 + 1.0, 31};
+    batch.push_back(find);
+  }
+  auto responses = c.Call(batch);
+  ASSERT_EQ(batch.size(), responses.size());
+  for (size_t i = 0; i < batch.size(); i += 2) {
+    EXPECT_EQ(responses[i].seq + 1, responses[i + 1].seq);
+    ASSERT_EQ(0, responses[i].status);
+    ASSERT_EQ(1u, responses[i + 1].ids.size());
+    EXPECT_EQ(responses[i].ids, responses[i + 1].ids);
+    EXPECT_FALSE(responses[i + 1].tiles[0].is_space);
+  }
+
+  // several clients reading at once
+  std::vector<std::thread> readers;
+  std::vector<int> wrong(4, 0);
+  for (int t = 0; t < 4; t++)
+    readers.emplace_back([&, t] {
+      Client r;
+      if (r.Connect(path)) {
+        wrong[t]++;
+        return;
+      }
+      std::vector<Request> reads(200);
+      for (auto& req : reads) {
+        req.op = Request::POINT_FIND;
+        req.plane = "a";
+        req.pt = {12, 12};
+      }
+      for (const auto& res : r.Call(reads)) wrong[t] += res.ids != std::vector<Id>{id};
+    });
+  for (auto& r : readers) r.join();
+  EXPECT_EQ(std::vector<int>(4, 0), wrong);
+
+  auto t = c.Delete("a", id);
+  ASSERT_TRUE(t.has_value());
+  EXPECT_EQ(Pt(10, 10), t->coord);
+  EXPECT_EQ(std::nullopt, c.Delete("a", id));
+  EXPECT_EQ(0, c.Drop("b"));
+  EXPECT_EQ(1, c.Drop("b"));
+  EXPECT_GT(server.NumBatches(), 0u);
+
+  server.Stop();
+  loop.join();
+}
@@ -0,0 +1,109 @@
+#include "../src/store.hpp"
+
+#include "test_stitch.hpp"
+
+TEST(TileStore, Chunks) {
+  TileStore s;
+  std::vector<size_t> ids;
+  for (size_t i = 0; i < 3 * TileStore::kChunk; i++) {
+    ids.push_back(s.Take());
+    s.Emplace(ids.back());
+  }
+  EXPECT_EQ(3u, s.NumChunks());
+  EXPECT_EQ(0u, s.NumFree());
+  // the emptied middle chunk is kept as the spare, so its slot is handed
+  // out again without mapping it
+  for (size_t i = TileStore::kChunk; i < 2 * TileStore::kChunk; i++) {
+    s.Erase(i);
+    s.Give(i);
+  }
+  EXPECT_EQ(3u, s.NumChunks());
+  EXPECT_EQ(2 * TileStore::kChunk - 1, s.Take());
+  s.Give(2 * TileStore::kChunk - 1);
+  EXPECT_EQ(3u, s.NumChunks());
+  // emptying another chunk releases the spare
+  for (size_t i = 2 * TileStore::kChunk; i < 3 * TileStore::kChunk; i++) {
+    s.Erase(i);
+    s.Give(i);
+  }
+  EXPECT_EQ(2u, s.NumChunks());
+  EXPECT_EQ(2 * TileStore::kChunk, s.NumFree());
+  for (size_t i = 0; i < TileStore::kChunk; i++) s.Emplace(s.Take());
+  EXPECT_EQ(2u, s.NumChunks());
+  EXPECT_EQ(TileStore::kChunk, s.NumFree());
+  EXPECT_TRUE(s.FreeList().empty());
+  EXPECT_EQ(std::vector<size_t>{1}, s.Released());
+  EXPECT_FALSE(s.Has(TileStore::kChunk));
+  // a free slot is handed out before the released chunk, lowest first
+  s.Erase(5);
+  s.Give(5);
+  EXPECT_EQ(5u, s.Take());
+  EXPECT_EQ(TileStore::kChunk, s.Take());
+  EXPECT_EQ(TileStore::kChunk + 1, s.Take());
+  EXPECT_EQ(3u, s.NumChunks());
+  // the copy hands out the same slots
+  TileStore t = s;
+  EXPECT_EQ(s, t);
+  EXPECT_EQ(s.Take(), t.Take());
+}
+
+TEST(TileStore, ShrinkToFit) {
+  TileStore s;
+  s.Reserve(2 * TileStore::kChunk + 10);
+  EXPECT_EQ(3u, s.NumChunks());
+  size_t i = s.Take();
+  s.Emplace(i);
+  s.ShrinkToFit();
+  EXPECT_EQ(i + 1, s.Size());
+  EXPECT_EQ(1u, s.NumChunks());
+  EXPECT_EQ(i, s.NumFree());
+}
+
+TEST(TileStore, Stitch) {
+  Stitch s({0, 0}, {1000, 1000});
+  for (int y = 0; y < 50; y++)
+    for (int x = 0; x < 50; x++)
+      s.Insert({{Len(x * 20), Len(y * 20)}, {10, 10}, false});
+  auto full = s.Stats();
+  for (Id id; s.Exist(id = s.AreaSearch({{0, 0}, {1000, 1000}}));)
+    s.Delete(id);
+  EXPECT_EQ(1u, s.NumTiles());
+  auto empty = s.Stats();
+  // the chunk of the last tile & the spare are left
+  EXPECT_LT(empty.tiles_bytes, full.tiles_bytes);
+  EXPECT_EQ(2 * TileStore::kChunk * sizeof(TileStore::Slot),
+            empty.tiles_bytes);
+  // restored planes reuse the same ids
+  auto t = Stitch::Deserialize(s.Serialize());
+  ASSERT_TRUE(t.has_value());
+  EXPECT_EQ(s.tiles_, t->tiles_);
+  EXPECT_EQ(s.Insert({{1, 1}, {1, 1}, false}),
+            t->Insert({{1, 1}, {1, 1}, false}));
+  s.ShrinkToFit();
+  EXPECT_LE(s.NumSlots(), TileStore::kChunk);
+  EXPECT_TRUE(s.Exist(s.PointFinding({1, 1})));
+}
+
+TEST(TileStore, Generations) {
+  TileStore s;
+  size_t i = s.Take();
+  s.Emplace(i);
+  auto gen = s.Gen(i);
+  s.Erase(i);
+  s.Give(i);  // kept as the spare
+  EXPECT_EQ(1u, s.NumChunks());
+  s.ShrinkToFit();  // drops the slot
+  EXPECT_EQ(0u, s.NumChunks());
+  EXPECT_GT(s.GenFloor(), gen);
+  // the reused slot never repeats an old generation
+  EXPECT_EQ(i, s.Take());
+  EXPECT_GT(s.Gen(i), gen);
+  s.Emplace(i);
+  s.Reserve(3);
+  std::vector<uint32_t> gens;
+  for (size_t j = 0; j < s.Size(); j++) gens.push_back(s.Gen(j));
+  s.ShrinkToFit();
+  EXPECT_EQ(i + 1, s.Size());
+  for (size_t j = s.Size(); j < gens.size(); j++)
+    EXPECT_GT(s.GenFloor(), gens[j]);
+}
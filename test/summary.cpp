@@ -0,0 +1,49 @@
+#include "../src/summary.hpp"
+
+#include <random>
+
+#include "test_stitch.hpp"
+
+TEST(Summary, MayOverlap) {
+  Summary s({{0, 0}, {64, 64}}, 4);
+  Tile t({10, 10}, {20, 3}, false);
+  s.Add(t);
+  EXPECT_TRUE(s.MayOverlap({{15, 11}, {1, 1}}));
+  EXPECT_TRUE(s.MayOverlap({{0, 0}, {64, 64}}));
+  EXPECT_FALSE(s.MayOverlap({{40, 40}, {10, 10}}));
+  EXPECT_FALSE(s.MayOverlap({{10, 20}, {20, 20}}));
+  s.Remove(t);
+  EXPECT_FALSE(s.MayOverlap({{0, 0}, {64, 64}}));
+  for (const auto& level : s.levels_)
+    for (const auto& node : level) {
+      EXPECT_EQ(0, node.count);
+      EXPECT_EQ(0, node.cover);
+    }
+}
+
+TEST(Summary, Stitch) {
+  // planes with & without the summary behave the same
+  Stitch a({0, 0}, {100, 100}), b = a;
+  b.EnableSummary(5);
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> pos(0, 95), len(1, 5);
+  std::vector<Id> ids;
+  for (int i = 0; i < 300; i++) {
+    Tile t({Len(pos(gen)), Len(pos(gen))}, {Len(len(gen)), Len(len(gen))},
+           false);
+    Id id = a.Insert(t);
+    EXPECT_EQ(id, b.Insert(t));
+    if (id != kNullId) ids.push_back(id);
+  }
+  for (size_t i = 0; i < ids.size(); i += 3) {
+    a.Delete(ids[i]);
+    b.Delete(ids[i]);
+  }
+  for (int i = 0; i < 300; i++) {
+    Tile area({Len(pos(gen)), Len(pos(gen))}, {Len(len(gen)), Len(len(gen))});
+    EXPECT_EQ(a.AreaSearch(area), b.AreaSearch(area));
+  }
+  EXPECT_EQ(std::vector<Id>{}, a.Validate());
+  EXPECT_EQ(std::vector<Id>{}, b.Validate());
+  TestStitch::CheckTiles(b);
+}
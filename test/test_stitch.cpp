@@ -14,7 +14,7 @@ TestStitch::TestStitch(Stitch&& s,
 
 std::vector<Id> TestStitch::Tiles(const Stitch& stitch) {
   std::vector<Id> ids;
-  for (size_t i = 0; i < stitch.tiles_.size(); i++)
+  for (size_t i = 0; i < stitch.NumSlots(); i++)
     if (stitch.Exist(i)) ids.push_back(i);
   return ids;
 }
@@ -117,7 +117,7 @@ void TestStitch::TestPointFinding() const {
   auto ids = Tiles(s);
   for (auto start : starts) {
     for (auto id : ids) {
-      const auto& t = s.tiles_[id].value();
+      const auto& t = s.Ref(id);
       EXPECT_EQ(id, s.PointFinding(t.coord, start));
       EXPECT_EQ(id, s.PointFinding(t.coord + Pt(t.size.x - 0.1, 0), start));
       EXPECT_EQ(id, s.PointFinding(t.coord + Pt(0, t.size.y - 0.1), start));
@@ -169,11 +169,11 @@ bool StitchEqual(const Stitch& l, const Stitch& r) {
   if (l.NumTiles() != r.NumTiles()) return false;
   // collect tiles
   std::vector<Id> l_ids;
-  for (size_t i = 0; i < l.tiles_.size(); i++)
-    if (l.tiles_[i].has_value()) l_ids.push_back(i);
+  for (size_t i = 0; i < l.NumSlots(); i++)
+    if (l.Exist(i)) l_ids.push_back(i);
   std::vector<Id> r_ids;
-  for (size_t i = 0; i < r.tiles_.size(); i++)
-    if (r.tiles_[i].has_value()) r_ids.push_back(i);
+  for (size_t i = 0; i < r.NumSlots(); i++)
+    if (r.Exist(i)) r_ids.push_back(i);
 
   if (l_ids != r_ids) return false;
   for (auto id : l_ids) {
@@ -298,3 +298,104 @@ Stitch TestStitch::TestDelete() const {
   for (auto id : Tiles(ns)) EXPECT_TRUE(ns.Ref(id).is_space);
   return ns;
 }
+
+// check the stitches, coverage & strips of a whole plane
+static void CheckPlane(const Stitch& s) {
+  TestStitch::CheckNeighbors(s);
+  TestStitch::CheckTiles(s);
+  TestStitch::CheckStrip(s);
+}
+
+TEST(Insert, InsideSpaceTile) {
+  // the top & bottom edges of the new tile split the same space tile
+  Stitch s({0, 0}, {8, 8});
+  Id id = s.Insert({{2, 2}, {2, 2}, false});
+  ASSERT_NE(kNullId, id);
+  EXPECT_EQ(Pt(2, 2), s.Ref(id).coord);
+  EXPECT_EQ(Pt(2, 2), s.Ref(id).size);
+  EXPECT_EQ(5u, s.NumTiles());
+  CheckPlane(s);
+}
+
+TEST(Insert, FlushWithSpaceTile) {
+  // nothing is split off the left or right of the new tile
+  Stitch s({0, 0}, {8, 8});
+  EXPECT_NE(kNullId, s.Insert({{0, 2}, {2, 2}, false}));
+  CheckPlane(s);
+  EXPECT_NE(kNullId, s.Insert({{6, 4}, {2, 2}, false}));
+  CheckPlane(s);
+  EXPECT_NE(kNullId, s.Insert({{0, 6}, {8, 1}, false}));
+  CheckPlane(s);
+  EXPECT_EQ(7u, s.NumTiles());
+}
+
+TEST(Insert, AboveNarrowerTiles) {
+  // the walk down along the left edge ends at a tile right of the new one
+  Stitch s({0, 0}, {8, 8});
+  EXPECT_NE(kNullId, s.Insert({{0, 0}, {3, 2}, false}));
+  Id id = s.Insert({{1, 2}, {1, 2}, false});
+  ASSERT_NE(kNullId, id);
+  EXPECT_EQ(Pt(1, 2), s.Ref(id).coord);
+  CheckPlane(s);
+}
+
+TEST(Insert, OutsidePlane) {
+  // tiles sticking out of the plane at the top or right are rejected
+  Stitch s({0, 0}, {8, 8});
+  EXPECT_EQ(kNullId, s.Insert({{6, 6}, {4, 4}, false}));
+  EXPECT_EQ(kNullId, s.Insert({{6, 0}, {4, 1}, false}));
+  EXPECT_EQ(kNullId, s.Insert({{0, 6}, {1, 4}, false}));
+  EXPECT_EQ(1u, s.NumTiles());
+  CheckPlane(s);
+}
+
+TEST(Delete, AtLeftBoundary) {
+  // a dead tile without left neighbors
+  Stitch s({0, 0}, {8, 8});
+  Id id = s.Insert({{0, 2}, {2, 2}, false});
+  EXPECT_TRUE(s.Delete(id).has_value());
+  EXPECT_EQ(1u, s.NumTiles());
+  CheckPlane(s);
+}
+
+TEST(Delete, AtRightBoundary) {
+  // a dead tile without right neighbors is merged leftwards as a whole
+  Stitch s({0, 0}, {8, 8});
+  Id id = s.Insert({{6, 2}, {2, 2}, false});
+  EXPECT_TRUE(s.Delete(id).has_value());
+  EXPECT_EQ(1u, s.NumTiles());
+  CheckPlane(s);
+}
+
+TEST(Delete, RightSpaceReachesBelow) {
+  // the space right of the dead tile also runs along the solid tile below
+  Stitch s({0, 0}, {10, 10});
+  EXPECT_NE(kNullId, s.Insert({{1, 0}, {1, 4}, false}));
+  EXPECT_NE(kNullId, s.Insert({{2, 0}, {2, 2}, false}));
+  Id id = s.Insert({{2, 2}, {2, 2}, false});
+  EXPECT_TRUE(s.Delete(id).has_value());
+  CheckPlane(s);
+  EXPECT_EQ(s.PointFinding({3, 3}), s.PointFinding({9, 3}));
+}
+
+TEST(Delete, LeftSpaceReachesBelow) {
+  // the space left of the dead tile also runs along the solid tile below
+  Stitch s({0, 0}, {10, 10});
+  EXPECT_NE(kNullId, s.Insert({{4, 0}, {1, 4}, false}));
+  EXPECT_NE(kNullId, s.Insert({{2, 0}, {2, 2}, false}));
+  Id id = s.Insert({{2, 2}, {2, 2}, false});
+  EXPECT_TRUE(s.Delete(id).has_value());
+  CheckPlane(s);
+  EXPECT_EQ(s.PointFinding({0, 3}), s.PointFinding({3, 3}));
+}
+
+TEST(Delete, MergeAgain) {
+  // the space pieces left of two solid tiles line up only once merged
+  Stitch s({0, 0}, {6, 6});
+  EXPECT_NE(kNullId, s.Insert({{5, 1}, {1, 2}, false}));
+  EXPECT_NE(kNullId, s.Insert({{5, 3}, {1, 2}, false}));
+  Id id = s.Insert({{4, 2}, {1, 2}, false});
+  EXPECT_TRUE(s.Delete(id).has_value());
+  CheckPlane(s);
+  EXPECT_EQ(5u, s.NumTiles());
+}
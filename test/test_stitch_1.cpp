@@ -1,9 +1,11 @@
+#include <random>
+
 #include "test_stitch.hpp"
 
 /* An example from `examples/stitch1.drawio.png` */
 TestStitch Stitch1() {
   Stitch s({0, 0}, {30, 24});
-  s.tiles_ = {
+  s.tiles_ = *TileStore::Restore({
       Tile({0, 0}, {30, 2}, kNullId, kNullId, kNullId, 4),
       Tile({0, 2}, {15, 3}, kNullId, 0, 2, 7),
       Tile({15, 2}, {5, 5}, 1, 0, 8, 9, false),
@@ -25,8 +27,7 @@ TestStitch Stitch1() {
       Tile({7, 18}, {6, 4}, 17, 16, 19, 20, false),
       Tile({13, 18}, {17, 4}, 18, 16, kNullId, 20),
       Tile({0, 22}, {30, 2}, kNullId, 17, kNullId, kNullId),
-  };
-  s.slots_ = {};
+  }, {}, {});
   s.last_inserted_ = 11;
   std::array<TestStitch::NeighborGolden, LAST> neighbor_golden;
   neighbor_golden[LEFT] = {
@@ -109,6 +110,192 @@ TEST(AreaEnum, Stitch1) {
             s.AreaEnum({s.coord_ + s.size_ / 4, s.size_ / 2}));
 }
 
+TEST(LazyViews, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  auto solid = [&](Id id) { return !s.Ref(id).is_space; };
+  // the first solid right neighbor past a space one, without building the
+  // whole list
+  auto right = s.RightNeighbors(2);
+  EXPECT_EQ(8, *right.begin());
+  EXPECT_EQ(3, *std::find_if(right.begin(), right.end(), solid));
+  // none among the right neighbors of 6, which are all space
+  right = s.RightNeighbors(6);
+  EXPECT_EQ(9, *++right.begin());
+  EXPECT_EQ(right.end(), std::find_if(right.begin(), right.end(), solid));
+  auto top = s.TopNeighbors(0);
+  EXPECT_EQ(3, *std::find_if(top.begin(), top.end(), solid));
+  EXPECT_EQ(0, std::distance(s.LeftNeighbors(0).begin(),
+                             s.LeftNeighbors(0).end()));
+  // the first tiles of a whole-plane enumeration
+  auto tiles = s.AreaTiles({s.coord_, s.size_});
+  EXPECT_EQ(13, *std::next(tiles.begin(), 5));
+  // neighbors of every tile in an area
+  std::vector<Id> lazy, eager;
+  for (auto id : s.AreaTiles({s.coord_ + s.size_ / 4, s.size_ / 2}))
+    for (auto n : s.BottomNeighbors(id)) lazy.push_back(n);
+  for (auto id : s.AreaEnum({s.coord_ + s.size_ / 4, s.size_ / 2}))
+    for (auto n : s.BottomNeighborFinding(id)) eager.push_back(n);
+  EXPECT_EQ(eager, lazy);
+  EXPECT_EQ(s.AreaTiles({{0, 0}, {40, 1}}).begin(),
+            s.AreaTiles({{0, 0}, {40, 1}}).end());
+}
+
+TEST(Stats, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  s.Delete(s.AreaSearch({s.coord_, s.size_}));
+  auto st = s.Stats(3, 16);
+  EXPECT_EQ(s.NumTiles(), st.solid + st.space);
+  size_t solid = 0, slivers = 0;
+  for (auto id : s.Tiles()) {
+    const auto& t = s.Ref(id);
+    solid += !t.is_space;
+    slivers += std::min(t.size.x, t.size.y) < 3;
+  }
+  EXPECT_EQ(solid, st.solid);
+  EXPECT_EQ(slivers, st.slivers);
+  size_t binned = 0;
+  for (const auto& [k, n] : st.area_histogram) binned += n;
+  EXPECT_EQ(s.NumTiles(), binned);
+  EXPECT_GE(st.aspect_histogram.begin()->first, 0);
+  EXPECT_GT(st.mean_walk, 0);
+  EXPECT_EQ(s.NumSlots(), st.slots);
+  EXPECT_EQ(s.tiles_.NumFree(), st.free_slots);
+  EXPECT_GE(st.wasted_bytes, st.free_slots * sizeof(TileStore::Slot));
+}
+
+TEST(ConnectedComponents, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  // join some tiles into larger shapes
+  s.Insert({{0, 0}, {30, 1}, false});
+  s.Insert({{0, 23}, {30, 1}, false});
+  auto c = s.ConnectedComponents(nullptr, 1);
+  ASSERT_EQ(s.NumSlots(), c.size());
+  // golden components by walking the touching solid tiles
+  for (auto id : s.Tiles()) {
+    if (s.Ref(id).is_space) {
+      EXPECT_EQ(kNullId, c[id]);
+      continue;
+    }
+    std::vector<Id> queue = {id}, visited = {id};
+    Id smallest = id;
+    while (queue.size()) {
+      Id cur = queue.back();
+      queue.pop_back();
+      smallest = std::min(smallest, cur);
+      for (auto side : {LEFT, BOTTOM, RIGHT, TOP})
+        for (auto n : TestStitch::GoldenNeighbors(s, cur, side))
+          if (!s.Ref(n).is_space &&
+              std::find(visited.begin(), visited.end(), n) == visited.end()) {
+            visited.push_back(n);
+            queue.push_back(n);
+          }
+    }
+    EXPECT_EQ(smallest, c[id]) << id;
+  }
+  EXPECT_EQ(c, s.ConnectedComponents(nullptr, 4));
+  // tall tiles only
+  auto tall = s.ConnectedComponents(
+      [](const Tile& t) { return t.size.y > 3; }, 2);
+  for (auto id : s.Tiles())
+    EXPECT_EQ(!s.Ref(id).is_space && s.Ref(id).size.y > 3,
+              tall[id] != kNullId);
+}
+
+TEST(Compact, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  size_t solids = 0;
+  for (auto id : s.Tiles()) solids += !s.Ref(id).is_space;
+  for (auto axis : {Stitch::X, Stitch::Y}) {
+    std::map<Id, Tile> moved;
+    s.Compact(axis, 1, [&](Id id, const Tile& t) { moved[id] = t; });
+    EXPECT_EQ(solids, moved.size());
+    for (const auto& [id, t] : moved) {
+      const auto& old = s.Ref(id);
+      EXPECT_EQ(old.size, t.size);
+      if (axis == Stitch::X) {
+        EXPECT_EQ(old.coord.y, t.coord.y);
+        EXPECT_LE(t.coord.x, old.coord.x);
+      } else {
+        EXPECT_EQ(old.coord.x, t.coord.x);
+        EXPECT_LE(t.coord.y, old.coord.y);
+      }
+    }
+    auto c = s.Compact(axis, 1);
+    EXPECT_EQ(s.NumTiles() > 0, c.NumTiles() > 0);
+    EXPECT_TRUE(c.Validate().empty());
+    size_t compacted = 0;
+    for (auto id : c.Tiles()) compacted += !c.Ref(id).is_space;
+    EXPECT_EQ(solids, compacted);
+  }
+  // tiles in a row close up to the spacing, other rows are independent
+  Stitch r({0, 0}, {30, 10});
+  Id a = r.Insert({{5, 0}, {2, 4}, false});
+  Id b = r.Insert({{15, 2}, {3, 4}, false});
+  Id c = r.Insert({{20, 5}, {3, 4}, false});
+  Id d = r.Insert({{23.5, 6}, {1, 1}, false});
+  std::map<Id, Tile> moved;
+  r.Compact(Stitch::X, 1, [&](Id id, const Tile& t) { moved[id] = t; });
+  EXPECT_EQ(0, moved[a].coord.x);
+  EXPECT_EQ(3, moved[b].coord.x);
+  EXPECT_EQ(7, moved[c].coord.x);
+  EXPECT_EQ(10.5, moved[d].coord.x);  // keeps its narrower gap
+}
+
+TEST(Compact, Build) {
+  // the plane built at once equals the one inserting the compacted tiles
+  auto tiles = [](const Stitch& s) {
+    std::vector<std::tuple<Len, Len, Len, Len, bool>> ts;
+    for (auto id : s.Tiles()) {
+      const auto& t = s.Ref(id);
+      ts.push_back({t.coord.x, t.coord.y, t.size.x, t.size.y, t.is_space});
+    }
+    std::sort(ts.begin(), ts.end());
+    return ts;
+  };
+  std::mt19937 gen(11);
+  for (int round = 0; round < 20; round++) {
+    Stitch s({Len(gen() % 5), Len(gen() % 5)}, {40, 30});
+    for (int n = 0; n < 40; n++)
+      s.Insert({s.coord_ + Pt(gen() % 36, gen() % 26),
+                {Len(1 + gen() % 6), Len(1 + gen() % 6)}, false});
+    for (auto axis : {Stitch::X, Stitch::Y}) {
+      auto c = s.Compact(axis, 1);
+      Stitch r(s.coord_, s.size_);
+      s.Compact(axis, 1, [&](Id, const Tile& t) { r.Insert(t); });
+      EXPECT_TRUE(c.Validate().empty()) << round;
+      EXPECT_EQ(tiles(r), tiles(c)) << round << " " << axis;
+    }
+  }
+}
+
+TEST(Serialize, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  s.EnableSummary(4);
+  s.Delete(s.AreaSearch({s.coord_, s.size_}));
+  auto data = s.Serialize();
+  auto t = Stitch::Deserialize(data);
+  ASSERT_TRUE(t.has_value());
+  EXPECT_EQ(s.tiles_, t->tiles_);
+  EXPECT_EQ(s.last_inserted_, t->last_inserted_);
+  EXPECT_TRUE(t->GetSummary().has_value());
+  // the same ids are assigned afterwards
+  EXPECT_EQ(s.Insert({{1, 1}, {1, 1}, false}),
+            t->Insert({{1, 1}, {1, 1}, false}));
+  for (size_t n : {size_t(0), size_t(7), data.size() - 1})
+    EXPECT_FALSE(Stitch::Deserialize(data.substr(0, n)).has_value());
+  // the summary depth closes the data, an unbounded one is rejected
+  for (int32_t depth : {-2, Summary::kMaxDepth + 1, 1 << 30}) {
+    auto bad = data;
+    memcpy(&bad[bad.size() - sizeof(depth)], &depth, sizeof(depth));
+    EXPECT_FALSE(Stitch::Deserialize(bad).has_value());
+  }
+}
+
 TEST(VerticalSplitMerge, Stitch1) {
   auto e = Stitch1();
   e.TestVerticalSplitMerge();
@@ -134,3 +321,428 @@ TEST(Delete, Stitch1) {
   auto e = Stitch1();
   e.TestDelete();
 }
+
+TEST(SpacingCheck, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  EXPECT_EQ((std::vector<Violation>{
+                {Violation::SPACING, 2, 11, 4},
+                {Violation::SPACING, 6, 11, 2},
+                {Violation::SPACING, 11, 18, 3},
+            }),
+            s.SpacingCheck(5, 1));
+  auto violations = s.SpacingCheck(6.5, 1);
+  EXPECT_EQ(6, violations.size());
+  EXPECT_EQ(violations, s.SpacingCheck(6.5, 4));
+}
+
+TEST(WidthCheck, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  EXPECT_EQ((std::vector<Violation>{
+                {Violation::WIDTH, 3, kNullId, 2},
+                {Violation::WIDTH, 10, kNullId, 2},
+            }),
+            s.WidthCheck(3, 1));
+  EXPECT_EQ(s.WidthCheck(3, 1), s.WidthCheck(3, 3));
+  EXPECT_EQ(0, s.WidthCheck(2).size());
+}
+
+TEST(Boolean, Stitch1) {
+  auto e = Stitch1();
+  const auto& a = e.s;
+  Stitch b(a.coord_, a.size_);
+  b.Insert({{10, 0}, {10, 24}});
+  // visit the result strip by strip
+  std::vector<Tile> tiles;
+  Stitch::Boolean(a, b, Stitch::AND,
+                  [&](const Tile& t) { tiles.push_back(t); });
+  EXPECT_EQ((std::vector<Tile>{
+                {{10, 18}, {3, 4}, false},
+                {{19, 15}, {1, 3}, false},
+                {{11, 14}, {9, 1}, false},
+                {{11, 11}, {8, 3}, false},
+                {{15, 2}, {5, 5}, false},
+            }),
+            tiles);
+  // build the result plane
+  auto solid_area = [](const Stitch& s) {
+    Len area = 0;
+    for (auto id : s.Tiles())
+      if (!s.Ref(id).is_space) area += s.Ref(id).size.x * s.Ref(id).size.y;
+    return area;
+  };
+  std::vector<std::tuple<Stitch::BoolOp, const Stitch*, Len>> cases = {
+      {Stitch::AND, &b, 73}, {Stitch::OR, &b, 161 + 240 - 73},
+      {Stitch::NOT, &b, 88}, {Stitch::XOR, &b, 161 + 240 - 2 * 73},
+      {Stitch::OR, &a, 161}, {Stitch::XOR, &a, 0},
+  };
+  for (const auto& [op, other, area] : cases) {
+    auto s = Stitch::Boolean(a, *other, op);
+    EXPECT_FLOAT_EQ(area, solid_area(s)) << op;
+    TestStitch::CheckNeighbors(s);
+    TestStitch::CheckTiles(s);
+    TestStitch::CheckStrip(s);
+  }
+  // random planes, `b` sticking out of `a`, against the tiles at each cell
+  std::mt19937 gen(7);
+  for (int round = 0; round < 20; round++) {
+    Stitch c({0, 0}, {40, 30}), d({Len(gen() % 10), Len(gen() % 10)},
+                                 {Len(20 + gen() % 30), Len(15 + gen() % 25)});
+    for (auto* s : {&c, &d})
+      for (int n = 0; n < 30; n++)
+        s->Insert({s->coord_ + Pt(gen() % 35, gen() % 25),
+                   {Len(1 + gen() % 8), Len(1 + gen() % 8)}, false});
+    for (auto op : {Stitch::AND, Stitch::OR, Stitch::NOT, Stitch::XOR}) {
+      auto s = Stitch::Boolean(c, d, op);
+      EXPECT_TRUE(s.Validate().empty()) << op;
+      for (Len y = 0.5; y < 30; y++)
+        for (Len x = 0.5; x < 40; x++) {
+          auto solid = [](const Stitch& p, Pt pt) {
+            return p.Plane().Contain(pt) && !p.Ref(p.PointFinding(pt)).is_space;
+          };
+          bool in_c = solid(c, {x, y}), in_d = solid(d, {x, y});
+          bool in = op == Stitch::AND   ? in_c && in_d
+                    : op == Stitch::OR  ? in_c || in_d
+                    : op == Stitch::NOT ? in_c && !in_d
+                                        : in_c != in_d;
+          ASSERT_EQ(in, solid(s, {x, y})) << op << " " << x << " " << y;
+        }
+    }
+  }
+}
+
+TEST(DensityMap, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  // solid area inside `area` by clipping all tiles
+  auto solid_area = [&](const Tile& area) {
+    Len sum = 0;
+    for (auto id : s.Tiles()) {
+      const auto& t = s.Ref(id);
+      if (t.is_space) continue;
+      Len w = std::min(t.UpperRightCorner().x, area.UpperRightCorner().x) -
+              std::max(t.coord.x, area.coord.x);
+      Len h = std::min(t.UpperRightCorner().y, area.UpperRightCorner().y) -
+              std::max(t.coord.y, area.coord.y);
+      if (w > 0 && h > 0) sum += w * h;
+    }
+    return sum;
+  };
+  // non-overlapping windows cover the whole plane
+  auto grid = s.DensityMap({s.coord_, s.size_}, {10, 8}, {10, 8}, 1);
+  EXPECT_EQ(3, grid.rows);
+  EXPECT_EQ(3, grid.cols);
+  Len sum = 0;
+  for (auto d : grid.values) sum += d * 80;
+  EXPECT_FLOAT_EQ(161, sum);
+  // overlapping windows
+  for (size_t threads : {1, 3}) {
+    Tile area({1, 2}, {27, 21});
+    Pt window(9, 6), step(4, 5);
+    grid = s.DensityMap(area, window, step, threads);
+    EXPECT_EQ(4, grid.rows);
+    EXPECT_EQ(5, grid.cols);
+    for (size_t r = 0; r < grid.rows; r++)
+      for (size_t c = 0; c < grid.cols; c++) {
+        Tile w(area.coord + Pt(c * step.x, r * step.y), window);
+        EXPECT_FLOAT_EQ(solid_area(w) / 54, grid.At(r, c)) << r << "," << c;
+      }
+  }
+  // window larger than the area
+  grid = s.DensityMap({s.coord_, s.size_}, {40, 8}, {1, 1});
+  EXPECT_EQ(0, grid.rows);
+  EXPECT_EQ(0, grid.cols);
+}
+
+TEST(Validate, Stitch1) {
+  auto e = Stitch1();
+  auto s = e.s;
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+  // every insertion & deletion only touches some tiles
+  s.TrackTouched(true);
+  EXPECT_NE(kNullId, s.Insert({{13, 15}, {6, 7}}));
+  EXPECT_LT(0, s.touched_.size());
+  EXPECT_EQ(std::vector<Id>{}, s.ValidateTouched());
+  EXPECT_TRUE(s.Delete(11).has_value());
+  EXPECT_EQ(std::vector<Id>{}, s.ValidateTouched());
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+  // broken stitch
+  s = e.s;
+  s.Ref(9).tr = 12;
+  EXPECT_EQ(std::vector<Id>{9}, s.Validate());
+  // not maximal strip
+  s = e.s;
+  s.Ref(3).is_space = true;
+  EXPECT_EQ((std::vector<Id>{3, 4}), s.Validate());
+  // not covered, the tile along the gap is invalid
+  s = e.s;
+  s.Ref(20).size.y = 1;
+  EXPECT_EQ(std::vector<Id>{20}, s.Validate());
+  // a tile over the whole plane, valid alone but not reached
+  s = e.s;
+  s.Ref(s.AllocTile()) = Tile(s.coord_, s.size_);
+  EXPECT_EQ(std::vector<Id>{kNullId}, s.Validate());
+  // a unit gap in the default plane, whose area overflows
+  Stitch q({0, 0}, {kLenMax, kLenMax});
+  Id id = q.Insert({{10, 10}, {10, 10}, false});
+  EXPECT_EQ(std::vector<Id>{}, q.Validate());
+  q.Ref(q.Ref(id).tr).size.y -= 1;
+  auto invalid = q.Validate();  // the tiles along the gap
+  EXPECT_NE(invalid.end(),
+            std::find(invalid.begin(), invalid.end(), q.Ref(id).tr));
+}
+
+TEST(Validate, ManyTiles) {
+  // cells on a dyadic grid, exact but too many for summed areas
+  Stitch s({0, 0}, {300, 7});
+  for (Len y = 0; y < 7; y += 0.25)
+    for (Len x = 0; x < 300; x += 0.25)
+      s.Insert({{x, y}, {0.125, 0.125}, false});
+  EXPECT_LT(60000u, s.NumTiles());
+  EXPECT_EQ(std::vector<Id>{}, s.Validate());
+}
+
+TEST(Rasterize, Stitch1) {
+  auto e = Stitch1();
+  const auto& s = e.s;
+  // compare each pixel with the tile containing its center
+  auto check = [&](const Pt& origin, Len pitch, size_t rows, size_t cols,
+                   const auto& pixels, bool label) {
+    for (size_t r = 0; r < rows; r++)
+      for (size_t c = 0; c < cols; c++) {
+        Pt center = origin + Pt(c + 0.5, r + 0.5) * pitch;
+        Id id = kNullId;
+        if (Tile(s.coord_, s.size_).Contain(center))
+          id = s.PointFinding(center);
+        bool solid = id != kNullId && !s.Ref(id).is_space;
+        EXPECT_EQ(solid ? (label ? id + 1 : 1) : 0, pixels[r * cols + c])
+            << r << "," << c;
+      }
+  };
+  for (size_t threads : {1, 4}) {
+    std::vector<uint8_t> bitmap(24 * 30);
+    s.Rasterize(s.coord_, 1, 24, 30, bitmap.data(), false, threads);
+    check(s.coord_, 1, 24, 30, bitmap, false);
+    std::vector<uint32_t> labels(30 * 40);
+    s.Rasterize({10, 10}, 0.5, 30, 40, labels.data(), true, threads);
+    check({10, 10}, 0.5, 30, 40, labels, true);
+  }
+  // labels past 255 do not fit into bytes
+  Stitch wide({0, 0}, {300, 2});
+  for (int x = 0; x < 300; x += 2) wide.Insert({{Len(x), 0}, {1, 1}, false});
+  ASSERT_LT(255u, wide.NumSlots());
+  std::vector<uint8_t> bytes(2 * 300, 7);
+  EXPECT_EQ(1, wide.Rasterize({0, 0}, 1, 2, 300, bytes.data(), true));
+  EXPECT_EQ(std::vector<uint8_t>(2 * 300, 7), bytes);
+  EXPECT_EQ(0, wide.Rasterize({0, 0}, 1, 2, 300, bytes.data()));
+  std::vector<uint32_t> labels(2 * 300);
+  EXPECT_EQ(0, wide.Rasterize({0, 0}, 1, 2, 300, labels.data(), true));
+  EXPECT_EQ(wide.PointFinding({298.5, 0.5}) + 1u, labels[298]);
+}
+
+TEST(Rasterize, CenterOnEdge) {
+  // solid tiles starting right at the last column or row of centers
+  Stitch s({0, 0}, {10, 10});
+  s.Insert({{5, 0}, {5, 5}, false});
+  s.Insert({{0, 5}, {5, 5}, false});
+  std::vector<uint8_t> pixels(3 * 3);
+  EXPECT_EQ(0, s.Rasterize({0, 0}, 2, 3, 3, pixels.data()));
+  EXPECT_EQ(std::vector<uint8_t>({0, 0, 1, 0, 0, 1, 1, 1, 0}), pixels);
+  // a single column or row of centers
+  uint8_t pixel = 0;
+  EXPECT_EQ(0, s.Rasterize({4, 0}, 2, 1, 1, &pixel));
+  EXPECT_EQ(1, pixel);
+  pixel = 0;
+  EXPECT_EQ(0, s.Rasterize({0, 4}, 2, 1, 1, &pixel));
+  EXPECT_EQ(1, pixel);
+  std::vector<uint8_t> row(3);
+  EXPECT_EQ(0, s.Rasterize({0, 4}, 2, 1, 3, row.data()));
+  EXPECT_EQ(std::vector<uint8_t>({1, 1, 0}), row);
+}
+
+TEST(SegmentWalk, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  typedef std::vector<Id> Ids;
+  EXPECT_EQ(Ids({1, 2, 3, 4}), s.SegmentWalk({1, 3}, 100, Stitch::EAST));
+  EXPECT_EQ(Ids({1, 2}), s.SegmentWalk({1, 3}, 16, Stitch::EAST));
+  EXPECT_EQ(Ids({1}), s.SegmentWalk({1, 3}, 0, Stitch::EAST));
+  EXPECT_EQ(Ids({1, 2}), s.SegmentWalk({1, 3}, 100, Stitch::EAST, true));
+  EXPECT_EQ(Ids({4, 3, 2, 1}), s.SegmentWalk({29, 3}, 100, Stitch::WEST));
+  Ids up = {0, 1, 7, 9, 10, 13, 16, 18, 20};
+  EXPECT_EQ(up, s.SegmentWalk({10, 0}, 24, Stitch::NORTH));
+  EXPECT_EQ(Ids(up.rbegin(), up.rend()),
+            s.SegmentWalk({10, 23}, 23, Stitch::SOUTH, false, 0));
+  EXPECT_EQ(Ids(), s.SegmentWalk({31, 0}, 1, Stitch::NORTH));
+  EXPECT_EQ(18, s.RayShoot({10, 0}, Stitch::NORTH));
+  EXPECT_EQ(6, s.RayShoot({0, 12}, Stitch::EAST));
+  EXPECT_EQ(18, s.RayShoot({29, 20}, Stitch::WEST));
+  EXPECT_EQ(2, s.RayShoot({16, 3}, Stitch::SOUTH));
+  EXPECT_EQ(kNullId, s.RayShoot({29, 23}, Stitch::SOUTH));
+}
+
+TEST(NearestSolid, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  typedef std::vector<std::pair<Id, Len>> Found;
+  EXPECT_EQ(Found({{2, 0}}), s.NearestSolid({16, 3}));
+  EXPECT_EQ(Found({{6, 3}}), s.NearestSolid({1, 6}));
+  EXPECT_EQ(Found(), s.NearestSolid({1, 6}, 2));
+  // the same as sorting all solid tiles by distance
+  for (Len x = 0; x < 30; x += 1.5)
+    for (Len y = 0; y < 24; y += 1.5) {
+      Found all;
+      for (auto id : e.Tiles(s)) {
+        const auto& t = s.Ref(id);
+        if (t.is_space) continue;
+        Len dx = std::max({Len(0), t.coord.x - x, x - t.UpperRightCorner().x});
+        Len dy = std::max({Len(0), t.coord.y - y, y - t.UpperRightCorner().y});
+        if (dx + dy <= 8) all.push_back({id, dx + dy});
+      }
+      std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) {
+        return std::make_pair(a.second, a.first) <
+               std::make_pair(b.second, b.first);
+      });
+      if (all.size() > 3) all.resize(3);
+      EXPECT_EQ(all, s.NearestSolid({x, y}, 8, 3));
+    }
+}
+
+TEST(Bloat, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  // a point is solid after growing (shrinking) by `d` if a solid tile lies
+  // within (all points within lie in solid tiles)
+  auto near = [&](const Pt& p, Len d, bool space) {
+    for (auto id : e.Tiles(s)) {
+      const auto& t = s.Ref(id);
+      if (t.is_space == space && t.coord.x - d < p.x &&
+          p.x < t.UpperRightCorner().x + d && t.coord.y - d < p.y &&
+          p.y < t.UpperRightCorner().y + d)
+        return true;
+    }
+    return false;
+  };
+  for (Len d : {0.0, 1.5, 4.0}) {
+    auto b = s.Bloat(d), h = s.Shrink(d);
+    EXPECT_TRUE(b.Validate().empty());
+    EXPECT_TRUE(h.Validate().empty());
+    for (Len x = 0.25; x < 30; x += 0.5)
+      for (Len y = 0.25; y < 24; y += 0.5) {
+        auto at = [](const Stitch& t, const Pt& p) {
+          return !t.Ref(t.PointFinding(p)).is_space;
+        };
+        EXPECT_EQ(near({x, y}, d, false), at(b, {x, y}));
+        bool inside = d < x && x < 30 - d && d < y && y < 24 - d;
+        EXPECT_EQ(inside && !near({x, y}, d, true), at(h, {x, y}));
+      }
+  }
+  // overlapping grown tiles are merged
+  EXPECT_EQ(1u, s.Bloat(100).NumTiles());
+  EXPECT_EQ(1u, s.Shrink(3).NumTiles());
+}
+
+TEST(Extend, Stitch1) {
+  // the same tiles as a plane of the new extent built from scratch
+  auto shapes = [](const Stitch& s) {
+    std::vector<std::tuple<Len, Len, Len, Len, bool>> v;
+    for (auto id : s.Tiles()) {
+      const auto& t = s.Ref(id);
+      v.push_back({t.coord.x, t.coord.y, t.size.x, t.size.y, t.is_space});
+    }
+    std::sort(v.begin(), v.end());
+    return v;
+  };
+  // solid tiles touch none, some or all of the borders
+  std::vector<std::pair<Pt, Pt>> extents = {
+      {{0, 0}, {30, 24}},
+      {{0, 2}, {30, 22}},
+      {{4, 0}, {26, 24}},
+      {{4, 2}, {24, 20}},
+  };
+  auto e = Stitch1();
+  for (const auto& [coord, size] : extents) {
+    Stitch s(coord, size);
+    for (auto id : e.s.Tiles())
+      if (!e.s.Ref(id).is_space) {
+        ASSERT_NE(kNullId, s.Insert(e.s.Ref(id)));
+      }
+    s.EnableSummary(3);
+    s.TrackTouched(true);
+    const Stitch old = s;
+    ASSERT_EQ(0, s.Extend({0, 0}, {40, 35}));
+    EXPECT_TRUE(s.Validate().empty()) << coord << size;
+    // only the tiles along the old border are modified
+    const Tile plane = old.Plane();
+    for (auto id : s.Touched()) {
+      if (!old.Exist(id)) continue;
+      const auto& t = old.Ref(id);
+      EXPECT_TRUE(t.coord.x == plane.coord.x || t.coord.y == plane.coord.y ||
+                  t.UpperRightCorner().x == plane.UpperRightCorner().x ||
+                  t.UpperRightCorner().y == plane.UpperRightCorner().y);
+    }
+    Stitch full({0, 0}, {40, 35});
+    for (auto id : s.Tiles())
+      if (!s.Ref(id).is_space) full.Insert(s.Ref(id));
+    EXPECT_EQ(shapes(full), shapes(s)) << coord << size;
+    EXPECT_NE(kNullId, s.Insert({{36, 30}, {2, 2}, false}));
+    EXPECT_TRUE(s.Validate().empty());
+  }
+  EXPECT_EQ(1, e.s.Extend({1, 0}, {40, 40}));
+  EXPECT_EQ(1, e.s.Extend({0, 0}, {29, 40}));
+}
+
+TEST(InsertHint, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  // overlapping solid tiles are rejected with or without the summary
+  for (bool summary : {false, true}) {
+    if (summary) s.EnableSummary(3);
+    EXPECT_EQ(kNullId, s.Insert({{14, 1}, {2, 2}, false}));
+    EXPECT_EQ(kNullId, s.Insert({{0, 12}, {5, 1}, false}));
+    EXPECT_EQ(11, s.last_inserted_);
+  }
+  // tiles without area are rejected
+  auto empty = [](Pt size) {
+    Tile t;  // the constructor rejects negative sizes
+    t.coord = {10, 10};
+    t.size = size;
+    t.is_space = false;
+    return t;
+  };
+  for (Pt size : {Pt(0, 0), Pt(0, 2), Pt(2, 0), Pt(-1, 2),
+                  Pt(std::numeric_limits<Len>::quiet_NaN(), 2)})
+    EXPECT_EQ(kNullId, s.Insert(empty(size)));
+  EXPECT_TRUE(s.Validate().empty());
+  // the next insert starts from the last one
+  Id id = s.Insert({{21, 8}, {2, 2}, false});
+  ASSERT_NE(kNullId, id);
+  EXPECT_EQ(id, s.last_inserted_);
+  EXPECT_TRUE(s.Validate().empty());
+}
+
+TEST(Handle, Stitch1) {
+  auto e = Stitch1();
+  auto& s = e.s;
+  auto h = s.GetHandle(11);
+  EXPECT_TRUE(s.Valid(h));
+  EXPECT_EQ(Handle(), s.GetHandle(100));
+  // other edits keep the solid tile
+  Id id = s.Insert({{21, 8}, {2, 2}, false});
+  auto g = s.GetHandle(id);
+  s.Delete(2);
+  EXPECT_EQ(11, s.Resolve(h));
+  // its id may come back for another tile, the handle stays outdated
+  s.Delete(11);
+  EXPECT_FALSE(s.Valid(h));
+  Id again = s.Insert({{11, 11}, {8, 4}, false});
+  EXPECT_EQ(kNullId, s.Resolve(h));
+  EXPECT_TRUE(s.Valid(s.GetHandle(again)));
+  EXPECT_EQ(id, s.Resolve(g));
+  // handles survive serialization
+  auto t = Stitch::Deserialize(s.Serialize());
+  ASSERT_TRUE(t.has_value());
+  EXPECT_EQ(id, t->Resolve(g));
+  EXPECT_FALSE(t->Valid(h));
+}
@@ -14,4 +14,7 @@ TEST(Tile, Cmp_Contain) {
   EXPECT_EQ(t.CmpY(coord + Pt(0.1, 0.1)), Tile::EQ);
   EXPECT_EQ(t.Contain(coord + size), false);
   EXPECT_EQ(t.Contain(coord), true);
+  EXPECT_EQ(t.Contain(t), true);
+  EXPECT_EQ(t.Contain(Tile(coord + Pt(0.1, 0.1), size)), false);
+  EXPECT_EQ(t.Contain(Tile(coord + Pt(0.1, 0.1), size / 2)), true);
 }
@@ -0,0 +1,42 @@
+// bench_insert: time a placement-style workload of Stitch::Insert
+//
+// usage: bench_insert [cells] [seed]
+//
+// Cells are placed row by row from left to right with random widths &
+// gaps, some of them overlapping the previous cell (rejected inserts), as
+// a legalizer or a detailed placer does.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "../src/stitch.hpp"
+
+int main(int argc, char** argv) {
+  size_t cells = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  std::mt19937 gen(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1);
+  const Len row = 10, width = 1000;
+  std::uniform_int_distribution<int> w(2, 8), gap(-2, 6);
+  std::vector<Tile> tiles;
+  for (Len x = 0, y = 0; tiles.size() < cells;) {
+    Len cw = w(gen);
+    if (x + cw > width) {
+      x = 0;
+      y += row;
+    }
+    tiles.push_back(Tile({x, y}, {cw, row}, false));
+    x = std::max(Len(0), x + cw + gap(gen));
+  }
+  Stitch s({0, 0}, {width, tiles.back().coord.y + row});
+  size_t inserted = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (const auto& t : tiles) inserted += s.Insert(t) != kNullId;
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  std::cout << "cells " << cells << " inserted " << inserted << " tiles "
+            << s.NumTiles() << "\n"
+            << "insert " << elapsed.count() * 1e9 / cells << " ns/cell\n";
+  return 0;
+}
@@ -0,0 +1,35 @@
+// stitchd: serve named corner-stitching planes over a Unix domain socket
+//
+// usage: stitchd <socket path> [threads]
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+#include "../src/server.hpp"
+
+static Server* server = nullptr;
+
+static void OnSignal(int) {
+  if (server) server->Stop();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " <socket path> [threads]\n";
+    return 2;
+  }
+  Server s(argv[1], argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0);
+  if (s.Listen()) {
+    std::cerr << argv[0] << ": cannot listen at " << argv[1] << "\n";
+    return 1;
+  }
+  server = &s;
+  std::signal(SIGINT, OnSignal);
+  std::signal(SIGTERM, OnSignal);
+  int status = s.Run();
+  server = nullptr;
+  std::cerr << argv[0] << ": served " << s.NumRequests() << " requests in "
+            << s.NumBatches() << " batches\n";
+  return status;
+}